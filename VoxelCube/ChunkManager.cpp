@@ -1 +1,229 @@
 #include "ChunkManager.h"
+#include <algorithm>
+
+const int ChunkManager::minDistance = 128;
+
+ChunkManager::ChunkManager(Octree* world, unsigned int threads) : world(world), pool(threads) {
+	world->TrackChunks(ChunkManager::ChunkDepth);
+	scratch.resize(pool.ThreadCount() + 1);	// The last one is for the calling thread
+	jobMeshes.resize(1);
+}
+
+ChunkManager::~ChunkManager() {
+	world->TrackChunks(0);
+	UnbindMeshes();
+}
+
+void ChunkManager::UnbindMeshes() {
+	meshes.clear();
+	meshBuffer.Delete();
+}
+
+size_t ChunkManager::Update(glm::vec3 viewer) {
+	chunks.clear();
+	if (!lodSet || glm::distance(viewer, lodViewer) >= ChunkManager::LodMoveDistance) {
+		lodViewer = viewer;
+		lodSet = true;
+		for (auto& mesh : meshes) {
+			if (mesh.second.lod != ChunkLod(mesh.first)) {
+				chunks.push_back(mesh.first);
+			}
+		}
+		size_t changed = chunks.size();
+		for (size_t i = 0; i < changed; i++) {
+			AddNeighbors(chunks[i]);
+		}
+	}
+
+	dirty.clear();
+	world->TakeDirtyChunks(dirty);
+	if (dirty.empty() && chunks.empty()) {
+		return 0;
+	}
+
+	uint32_t chunkDepth = world->GetChunkDepth();
+	size_t edited = chunks.size();
+	for (uint32_t LocCode : dirty) {
+		uint32_t depth = Octree::GetLocDepth(LocCode);
+		if (depth < chunkDepth) {
+			// A bigger edit: every chunk inside it that had a mesh, or has something to mesh now
+			uint32_t shift = 3 * (chunkDepth - depth);
+			for (auto& mesh : meshes) {
+				if ((mesh.first >> shift) == LocCode) {
+					chunks.push_back(mesh.first);
+				}
+			}
+		}
+		world->GetChunks(LocCode, chunks);
+	}
+	// The octree only marks the neighbors of an edit against a chunk border, but in a coarser chunk the edit can change
+	// a cell against the border from further away
+	for (size_t i = edited, end = chunks.size(); i < end; i++) {
+		if (ChunkLod(chunks[i]) > 0) {
+			AddNeighbors(chunks[i]);
+		}
+	}
+	std::sort(chunks.begin(), chunks.end());
+	chunks.erase(std::unique(chunks.begin(), chunks.end()), chunks.end());
+
+	// Waking the workers costs more than meshing a few chunks
+	if (chunks.size() < ChunkManager::ParallelChunks) {
+		for (uint32_t chunk : chunks) {
+			MeshChunk(chunk, jobMeshes[0], scratch.back());
+			InstallMesh(chunk, jobMeshes[0]);
+		}
+		return chunks.size();
+	}
+
+	// Every job fills its own vertex array, the GL upload happens here as the jobs come back
+	if (jobMeshes.size() < chunks.size()) {
+		jobMeshes.resize(chunks.size());
+	}
+	pool.Start(chunks.size(), [this](size_t job, unsigned int worker) {
+		MeshChunk(chunks[job], jobMeshes[job], scratch[worker]);
+		while (!completed.Push(job)) {
+			std::this_thread::yield();
+		}
+	});
+
+	size_t installed = 0;
+	while (installed < chunks.size()) {
+		size_t job;
+		if (completed.Pop(job)) {
+			InstallMesh(chunks[job], jobMeshes[job]);
+			installed++;
+		}
+		else {
+			std::this_thread::yield();
+		}
+	}
+	pool.Wait();
+	return chunks.size();
+}
+
+void ChunkManager::MeshChunk(uint32_t chunk, Renderer& mesh, MeshScratch& scratch) {
+	mesh.vertexArray.clear();	// Also makes CreateMesh() set the origin to the chunk
+	// The border faces are culled against what the neighbors draw at their own LOD, so there are no cracks between them
+	uint8_t lod = ChunkLod(chunk);
+	size_t neighborDetail[6];
+	for (uint8_t face = 0; face < 6; face++) {
+		uint32_t neighbor = Octree::NeighborLocCode(chunk, face);
+		neighborDetail[face] = ChunkManager::ChunkDepth - (neighbor == 0 ? lod : ChunkLod(neighbor));
+	}
+	world->CreateMesh(&mesh, chunk, ChunkManager::ChunkDepth - lod, MeshingMode_BinaryGreedy, &scratch, neighborDetail);
+}
+
+void ChunkManager::AddNeighbors(uint32_t chunk) {
+	for (uint8_t face = 0; face < 6; face++) {
+		uint32_t neighbor = Octree::NeighborLocCode(chunk, face);
+		if (neighbor != 0 && meshes.count(neighbor) > 0) {
+			chunks.push_back(neighbor);
+		}
+	}
+}
+
+uint8_t ChunkManager::ChunkLod(uint32_t chunk) {
+	glm::vec3 pos = Octree::LocCodeToPos(chunk);
+	glm::vec3 end = pos + glm::vec3((float)(1U << ChunkManager::ChunkDepth));
+	float distance = glm::length(glm::max(glm::max(pos - lodViewer, lodViewer - end), glm::vec3(0.0f)));
+
+	// One more LOD for every doubling of the distance past minDistance
+	uint8_t lod = 0;
+	for (float ring = (float)ChunkManager::minDistance; distance >= ring && lod < ChunkManager::ChunkDepth; ring *= 2) {
+		lod++;
+	}
+	return lod;
+}
+
+void ChunkManager::InstallMesh(uint32_t chunk, Renderer& result) {
+	auto it = meshes.find(chunk);
+	if (it != meshes.end()) {
+		meshBuffer.Free(it->second.firstVertex, it->second.mesh.vertexArray.size());
+	}
+	uint8_t lod = ChunkLod(chunk);
+	if (result.vertexArray.empty() && lod == 0) {
+		if (it != meshes.end()) {
+			meshes.erase(it);
+		}
+		return;
+	}
+
+	// Swapped rather than copied. The old vertex array stays with the result, to be reused by the next job
+	ChunkMesh& mesh = meshes[chunk];
+	mesh.mesh.vertexArray.swap(result.vertexArray);
+	mesh.mesh.SetMeshOrigin(result.GetMeshOrigin(), result.GetMeshUnit());
+	mesh.firstVertex = mesh.mesh.vertexArray.empty() ? 0 : meshBuffer.Upload(mesh.mesh.vertexArray);
+	mesh.lod = lod;
+}
+
+void ChunkManager::Render(Camera camera, const unsigned int WIDTH, const unsigned int HEIGHT) {
+	Renderer::UseShader(&BlockShader::blocks(), camera, WIDTH, HEIGHT);
+
+	glm::mat4 projectionView = Renderer::ProjectionMatrix(camera, WIDTH, HEIGHT) * camera.GetViewMatrix();
+	Frustum frustum(projectionView);
+	visible.clear();
+	boxesTested = world->GetVisibleChunks(frustum, visible);
+
+	occluders.clear();
+	world->GetOccluders(frustum, camera.Position, ChunkManager::OccluderSize, ChunkManager::MaxOccluders, occluders);
+	occlusionCuller.Begin(projectionView, camera.Position);
+	for (glm::vec4& box : occluders) {
+		glm::vec3 pos(box.x, box.y, box.z);
+		occlusionCuller.AddOccluder(pos, pos + glm::vec3(box.w));
+	}
+	occlusionCuller.BuildPyramid();
+
+	chunksDrawn = 0;
+	chunksOccluded = 0;
+	float chunkSize = (float)(1U << ChunkManager::ChunkDepth);
+	for (uint32_t chunk : visible) {
+		auto it = meshes.find(chunk);
+		if (it == meshes.end() || it->second.mesh.vertexArray.empty()) {
+			continue;	// Nothing to see in it
+		}
+		glm::vec3 pos = Octree::LocCodeToPos(chunk);
+		if (!occlusionCuller.IsVisible(pos, pos + glm::vec3(chunkSize))) {
+			chunksOccluded++;
+			continue;
+		}
+		Renderer& mesh = it->second.mesh;
+		meshBuffer.AddDraw(it->second.firstVertex, mesh.vertexArray.size() / Renderer::FACESIZE,
+			glm::vec3(mesh.GetMeshOrigin()), (float)mesh.GetMeshUnit());
+		chunksDrawn++;
+	}
+	meshBuffer.Draw();
+	meshBuffer.EndFrame();
+}
+
+size_t ChunkManager::ChunkCount() {
+	size_t count = 0;
+	for (auto& mesh : meshes) {
+		count += !mesh.second.mesh.vertexArray.empty();
+	}
+	return count;
+}
+
+size_t ChunkManager::FaceCount() {
+	size_t faces = 0;
+	for (auto& mesh : meshes) {
+		faces += mesh.second.mesh.vertexArray.size() / Renderer::FACESIZE;
+	}
+	return faces;
+}
+
+Renderer* ChunkManager::GetChunkMesh(uint32_t chunk) {
+	auto it = meshes.find(chunk);
+	return it == meshes.end() ? nullptr : &it->second.mesh;
+}
+
+size_t ChunkManager::BoxesTested() {
+	return boxesTested;
+}
+
+size_t ChunkManager::ChunksDrawn() {
+	return chunksDrawn;
+}
+
+size_t ChunkManager::ChunksOccluded() {
+	return chunksOccluded;
+}
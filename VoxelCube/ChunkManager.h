@@ -1,10 +1,109 @@
 #pragma once
+
+#include "Core/CompletionQueue.h"
+#include "Core/MeshBuffer.h"
+#include "Core/OcclusionCuller.h"
+#include "Core/WorkerPool.h"
+#include "World/Octree.h"
+#include <unordered_map>
+#include <vector>
+
+/* Keeps one mesh per chunk of the world, and only rebuilds the chunks that changed
+*
+* The octree marks the chunks its edits touch (see Octree::TrackChunks), and Update() re-meshes and re-uploads just
+* those. A single block edit costs one chunk, or a few if the block lies against the border of its chunk.
+* Chunks are meshed with MeshingMode_BinaryGreedy: the binary culling looks into the neighboring chunks, so the faces
+* on chunk borders are culled the same as inside, and chunks inside a larger block are meshed as well.
+* The chunks are meshed as jobs on a worker pool, each into its own vertex array with its own scratch space. Finished
+* jobs come back through a lock-free queue, and are uploaded on the thread that called Update(), which owns the GL
+* context. The tree is only read while the jobs run, and it can't change meanwhile, as Update() waits for all of them.
+* All meshes live in one MeshBuffer, so uploading a chunk doesn't create buffers, and a re-meshed chunk frees its old
+* range only once the frames drawing from it are done. Render() draws them all with a single multi-draw call.
+* Only the chunks in the view frustum are drawn. They are found by walking the octree, so a subtree outside of the
+* frustum costs one box test, however many chunks it holds (see Octree::GetVisibleChunks). Of those, the chunks hidden
+* behind the nearest blocks are skipped as well, see OcclusionCuller.
+* Chunks further away are meshed at a lower level of detail (LOD): LOD n merges 2^n x 2^n x 2^n blocks into one cube,
+* from LOD 0 closer than minDistance, to LOD ChunkDepth (the chunk as one cube). The LODs are only re-evaluated once
+* the viewer has moved LodMoveDistance, and only the chunks whose LOD changed are re-meshed, with their neighbors.
+* The border faces of a chunk are culled against what its neighbors draw at their own LOD, so there are no cracks where
+* the LOD changes: a face is kept unless the neighbor's cubes cover all of it (see Octree::CreateMesh).
+*/
 class ChunkManager
 {
+public:
 	// For now use an array
 	const static int ChunkDepth = 5;	// A chunk is defined as 32x32x32 nodes
 	const static int minDistance;		// minDistance at which the LOD changes. Subsequent LOD changes happen at powers of 2 times this distance
+	constexpr static float LodMoveDistance = 8.0f;	// How far the viewer moves before the LODs are looked at again
 
-	
-};
+	const static size_t ParallelChunks = 4;	// Updates with fewer dirty chunks than this are meshed without the workers
+
+	const static size_t MaxOccluders = 1024;		// Nearest blocks drawn into the occlusion depth buffer per frame
+	constexpr static float OccluderSize = 0.02f;	// Smallest of those blocks, in width per unit of distance
+
+	/* Starts tracking the chunks of the world. Everything is meshed on the first Update()
+	0 threads means one per hardware thread */
+	ChunkManager(Octree* world, unsigned int threads = 0);
+	~ChunkManager();
+
+	/* Re-mesh and re-upload the chunks changed since the last update, and the chunks whose LOD changed as the viewer
+	moved. Returns the number of chunks meshed */
+	size_t Update(glm::vec3 viewer);
+
+	/* Render the chunk meshes in view of the camera */
+	void Render(Camera camera, const unsigned int WIDTH, const unsigned int HEIGHT);
+
+	/* Delete the meshes and their buffers. The destructor does this too, but call it while the GL context exists */
+	void UnbindMeshes();
 
+	/* Number of chunks with faces, and of faces in all of them */
+	size_t ChunkCount();
+	size_t FaceCount();
+
+	/* The mesh of a chunk, with its vertices, origin and unit (2^LOD). nullptr if the chunk has no mesh */
+	Renderer* GetChunkMesh(uint32_t chunk);
+
+	/* Of the last Render(): the number of octree boxes tested against the frustum, of chunks drawn, and of chunks in the
+	frustum that were hidden behind others */
+	size_t BoxesTested();
+	size_t ChunksDrawn();
+	size_t ChunksOccluded();
+
+private:
+	Octree* world;
+	struct ChunkMesh {
+		Renderer mesh;	// Only its vertex array and origin are used, the vertices are drawn from meshBuffer
+		size_t firstVertex;
+		uint8_t lod;
+	};
+	// Chunk LocCode -> its mesh. Chunks with no faces have no entry, unless they might have some at a finer LOD
+	std::unordered_map<uint32_t, ChunkMesh> meshes;
+	glm::vec3 lodViewer = glm::vec3(0.0f);	// Where the viewer was when the LODs were last looked at
+	bool lodSet = false;
+	MeshBuffer meshBuffer;
+	std::vector<uint32_t> dirty;	// Scratch lists for Update()
+	std::vector<uint32_t> chunks;	// The chunks to mesh, job i meshes chunks[i]
+	std::vector<Renderer> jobMeshes;	// The mesh made by job i, before it is installed
+	std::vector<uint32_t> visible;	// Scratch list for Render()
+	std::vector<glm::vec4> occluders;	// Scratch list for Render()
+	OcclusionCuller occlusionCuller;
+	size_t boxesTested = 0;
+	size_t chunksDrawn = 0;
+	size_t chunksOccluded = 0;
+	std::vector<MeshScratch> scratch;	// One per worker, plus one for the calling thread
+	CompletionQueue<size_t> completed;	// Jobs that are done
+	WorkerPool pool;	// Last, so the workers stop before the rest goes away
+
+	/* The LOD of a chunk, from the distance between lodViewer and the nearest point of the chunk */
+	uint8_t ChunkLod(uint32_t chunk);
+
+	/* Queue the neighbors of a chunk that have a mesh, as their border faces depend on the chunk */
+	void AddNeighbors(uint32_t chunk);
+
+	/* Mesh a chunk into the given renderer, at its LOD. Safe to run on any thread with its own scratch space */
+	void MeshChunk(uint32_t chunk, Renderer& mesh, MeshScratch& scratch);
+
+	/* Make the result the chunk's mesh and upload it, or drop the chunk's mesh if the result is empty at LOD 0. Only on
+	the thread with the GL context */
+	void InstallMesh(uint32_t chunk, Renderer& result);
+};
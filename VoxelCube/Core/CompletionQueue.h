@@ -0,0 +1,90 @@
+#pragma once
+
+/* Bounded lock-free queue, used to hand finished jobs from the worker threads back to the main thread
+*
+* Any number of threads can push and pop. Every slot has a sequence number that says whose turn it is: a pusher may
+* fill slot i when its sequence is the push position, a popper may empty it when it is the push position + 1. So a
+* thread only ever contends on one compare-and-swap of the position, and no one waits for a lock held by a thread
+* that was put to sleep. When the queue is full, Push() fails instead of blocking.
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+template <typename T>
+class CompletionQueue {
+public:
+	/* The capacity is rounded up to a power of two */
+	CompletionQueue(size_t capacity = 1024) {
+		size_t size = 2;
+		while (size < capacity) {
+			size *= 2;
+		}
+		slots.reset(new Slot[size]);
+		mask = size - 1;
+		for (size_t i = 0; i < size; i++) {
+			slots[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	/* Add a value at the back. Returns false if the queue is full */
+	bool Push(const T& value) {
+		size_t pos = pushPos.load(std::memory_order_relaxed);
+		Slot* slot;
+		for (;;) {
+			slot = &slots[pos & mask];
+			intptr_t diff = (intptr_t)slot->sequence.load(std::memory_order_acquire) - (intptr_t)pos;
+			if (diff == 0) {
+				if (pushPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			}
+			else if (diff < 0) {
+				return false;	// Still holds the value from a lap ago
+			}
+			else {
+				pos = pushPos.load(std::memory_order_relaxed);
+			}
+		}
+		slot->value = value;
+		slot->sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	/* Take the value at the front. Returns false if the queue is empty */
+	bool Pop(T& value) {
+		size_t pos = popPos.load(std::memory_order_relaxed);
+		Slot* slot;
+		for (;;) {
+			slot = &slots[pos & mask];
+			intptr_t diff = (intptr_t)slot->sequence.load(std::memory_order_acquire) - (intptr_t)(pos + 1);
+			if (diff == 0) {
+				if (popPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			}
+			else if (diff < 0) {
+				return false;	// Not pushed yet
+			}
+			else {
+				pos = popPos.load(std::memory_order_relaxed);
+			}
+		}
+		value = slot->value;
+		slot->sequence.store(pos + mask + 1, std::memory_order_release);	// Free for the push one lap later
+		return true;
+	}
+
+private:
+	struct Slot {
+		std::atomic<size_t> sequence;
+		T value;
+	};
+
+	std::unique_ptr<Slot[]> slots;
+	size_t mask;
+	alignas(64) std::atomic<size_t> pushPos{ 0 };	// Own cache lines, so pushers and the popper don't share one
+	alignas(64) std::atomic<size_t> popPos{ 0 };
+};
@@ -0,0 +1,35 @@
+#include "Frustum.h"
+
+Frustum::Frustum(const glm::mat4& projectionView) {
+	// glm is column major, so row i of the matrix is element i of every column
+	glm::vec4 rows[4];
+	for (int i = 0; i < 4; i++) {
+		rows[i] = glm::vec4(projectionView[0][i], projectionView[1][i], projectionView[2][i], projectionView[3][i]);
+	}
+	// -w <= x, y, z <= w in clip space
+	for (int axis = 0; axis < 3; axis++) {
+		planes[2 * axis] = rows[3] + rows[axis];
+		planes[2 * axis + 1] = rows[3] - rows[axis];
+	}
+}
+
+FrustumTest Frustum::TestBox(glm::vec3 min, glm::vec3 max, uint8_t& planeMask) const {
+	uint8_t mask = planeMask;
+	for (int i = 0; i < 6; i++) {
+		if (!((planeMask >> i) & 1U)) {
+			continue;
+		}
+		const glm::vec4& plane = planes[i];
+		// The corner furthest along the normal, and the one furthest against it
+		glm::vec3 front(plane.x >= 0 ? max.x : min.x, plane.y >= 0 ? max.y : min.y, plane.z >= 0 ? max.z : min.z);
+		glm::vec3 back(plane.x >= 0 ? min.x : max.x, plane.y >= 0 ? min.y : max.y, plane.z >= 0 ? min.z : max.z);
+		if (plane.x * front.x + plane.y * front.y + plane.z * front.z + plane.w < 0) {
+			return FrustumTest_Outside;
+		}
+		if (plane.x * back.x + plane.y * back.y + plane.z * back.z + plane.w >= 0) {
+			mask &= ~(uint8_t)(1U << i);
+		}
+	}
+	planeMask = mask;
+	return mask == 0 ? FrustumTest_Inside : FrustumTest_Intersects;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+/* The view frustum of a camera, as six planes, for culling boxes on the CPU
+*
+* The planes are taken from the rows of projection * view (Gribb and Hartmann), so they are in world space and point
+* inwards. A box is outside once it lies fully behind one plane. Testing the corner of the box furthest along a plane's
+* normal tells whether any of the box is in front of it, the opposite corner whether all of it is.
+* TestBox() takes a mask of the planes left to test. Walking a hierarchy of boxes, pass a child the mask its parent
+* came back with: planes the parent lies fully in front of are skipped, and a mask of 0 means the box is fully inside.
+*/
+
+#include <glm/glm.hpp>
+#include <cstdint>
+
+enum FrustumTest {
+	FrustumTest_Outside = 0,
+	FrustumTest_Intersects = 1,	// Partly inside, or too close to the edge of the frustum to tell
+	FrustumTest_Inside = 2,
+};
+
+class Frustum
+{
+public:
+	static const uint8_t ALLPLANES = 63;	// Bit i for plane i: left, right, bottom, top, near, far
+
+	/* The frustum of projection * view. The boxes tested are in world space */
+	Frustum(const glm::mat4& projectionView);
+
+	/* Test an axis-aligned box against the planes in the mask. The planes the box lies fully in front of are cleared
+	from the mask, so for Inside it comes back as 0. For Outside the mask is left as it is */
+	FrustumTest TestBox(glm::vec3 min, glm::vec3 max, uint8_t& planeMask) const;
+
+private:
+	glm::vec4 planes[6];	// xyz is the normal, pointing inwards, and w the offset. Not normalized
+};
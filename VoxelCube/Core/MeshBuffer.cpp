@@ -0,0 +1,280 @@
+#include "MeshBuffer.h"
+#include "Renderer.h"
+#include <algorithm>
+#include <cstring>
+
+MeshBuffer::MeshBuffer(size_t capacity, bool allowMultiDraw) : capacity(capacity), allowMultiDraw(allowMultiDraw) {
+}
+
+MeshBuffer::~MeshBuffer() {
+	Delete();
+}
+
+size_t MeshBuffer::Upload(const std::vector<uint32_t>& vertices) {
+	if (VBO == 0) {
+		Create();
+		Release(0, capacity);
+	}
+
+	size_t count = vertices.size();
+	size_t first = 0;
+	Reclaim(false);
+	if (!Allocate(count, first)) {
+		// Everything that is waiting for the GPU might make room, otherwise grow
+		Reclaim(true);
+		if (!Allocate(count, first)) {
+			Grow(capacity + count);
+			Allocate(count, first);
+		}
+	}
+
+	size_t bytes = count * sizeof(uint32_t);
+	if (persistent) {
+		std::memcpy(mapped + first, vertices.data(), bytes);
+	}
+	else {
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		void* range = glMapBufferRange(GL_ARRAY_BUFFER, first * sizeof(uint32_t), bytes,
+			GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+		if (range != nullptr) {
+			std::memcpy(range, vertices.data(), bytes);
+		}
+		// The map fails when the driver is out of memory, and the contents can be lost while mapped, which the unmap
+		// reports. Either way the vertices go through glBufferSubData, which may have to wait for the GPU
+		if (range == nullptr || glUnmapBuffer(GL_ARRAY_BUFFER) == GL_FALSE) {
+			glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(uint32_t), bytes, vertices.data());
+		}
+	}
+	return first;
+}
+
+void MeshBuffer::Free(size_t first, size_t count) {
+	if (count > 0) {
+		freed.push_back({ first, count });
+	}
+}
+
+void MeshBuffer::AddDraw(size_t firstVertex, size_t faces, glm::vec3 origin, float unit) {
+	commands.push_back({ (GLuint)(faces * 6), 1, 0, (GLint)firstVertex, (GLuint)commands.size() });
+	chunks.push_back(glm::vec4(origin, unit));
+	maxFaces = std::max(maxFaces, faces);
+}
+
+void MeshBuffer::Draw() {
+	if (commands.empty() || VAO == 0) {
+		commands.clear();
+		chunks.clear();
+		return;
+	}
+
+	glBindVertexArray(VAO);
+	Renderer::BindQuadIndices(maxFaces);	// Element buffer binding is part of the VAO
+#ifdef GL_DRAW_INDIRECT_BUFFER
+	if (multiDraw) {
+		// Respecified every frame, which orphans the data the previous frame may still be reading
+		glBindBuffer(GL_ARRAY_BUFFER, chunkBuffer);
+		glBufferData(GL_ARRAY_BUFFER, chunks.size() * sizeof(glm::vec4), chunks.data(), GL_STREAM_DRAW);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawCommand), commands.data(), GL_STREAM_DRAW);
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)0, (GLsizei)commands.size(), 0);
+	}
+#endif
+	if (!multiDraw) {
+		for (size_t i = 0; i < commands.size(); i++) {
+			glVertexAttrib4f(1, chunks[i].x, chunks[i].y, chunks[i].z, chunks[i].w);
+			glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)commands[i].count, GL_UNSIGNED_INT, (void*)0, commands[i].baseVertex);
+		}
+	}
+	glBindVertexArray(0);
+
+	commands.clear();
+	chunks.clear();
+	maxFaces = 0;
+}
+
+void MeshBuffer::EndFrame() {
+	if (!freed.empty()) {
+		fenced.push_back({ glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), std::move(freed) });
+		freed.clear();
+	}
+	Reclaim(false);
+}
+
+void MeshBuffer::Delete() {
+	for (FencedRanges& ranges : fenced) {
+		glDeleteSync(ranges.fence);
+	}
+	fenced.clear();
+	freed.clear();
+	freeRanges.clear();
+	cursor = 0;
+	if (VBO != 0) {
+		if (persistent) {
+			glBindBuffer(GL_ARRAY_BUFFER, VBO);
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+			mapped = nullptr;
+		}
+		glDeleteBuffers(1, &VBO);
+		glDeleteVertexArrays(1, &VAO);
+		VBO = 0;
+		VAO = 0;
+	}
+	if (multiDraw) {
+		glDeleteBuffers(1, &commandBuffer);
+		glDeleteBuffers(1, &chunkBuffer);
+		commandBuffer = 0;
+		chunkBuffer = 0;
+		multiDraw = false;
+	}
+	commands.clear();
+	chunks.clear();
+	maxFaces = 0;
+}
+
+bool MeshBuffer::IsPersistent() {
+	return persistent;
+}
+
+bool MeshBuffer::IsMultiDraw() {
+	return multiDraw;
+}
+
+size_t MeshBuffer::Capacity() {
+	return capacity;
+}
+
+void MeshBuffer::Create() {
+	glGenBuffers(1, &VBO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	size_t bytes = capacity * sizeof(uint32_t);
+
+#ifdef GL_MAP_PERSISTENT_BIT
+	// Only loaded if the context has GL 4.4 or ARB_buffer_storage
+	persistent = glBufferStorage != nullptr;
+	if (persistent) {
+		const GLbitfield FLAGS = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_ARRAY_BUFFER, bytes, nullptr, FLAGS);
+		mapped = (uint32_t*)glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes, FLAGS);
+	}
+#endif
+	if (!persistent) {
+		glBufferData(GL_ARRAY_BUFFER, bytes, nullptr, GL_DYNAMIC_DRAW);
+	}
+
+	if (VAO == 0) {
+		glGenVertexArrays(1, &VAO);
+#ifdef GL_DRAW_INDIRECT_BUFFER
+		// The per-chunk attribute relies on a non-zero base instance in the commands, which takes GL 4.2, and the call
+		// itself GL 4.3. The loaded glad has no extensions, so the version decides. Otherwise Draw() loops
+		multiDraw = allowMultiDraw && GLAD_GL_VERSION_4_3 && glMultiDrawElementsIndirect != nullptr;
+		if (multiDraw) {
+			glGenBuffers(1, &commandBuffer);
+			glGenBuffers(1, &chunkBuffer);
+		}
+#endif
+	}
+	SetupVertexArray();
+}
+
+void MeshBuffer::Grow(size_t minCapacity) {
+	size_t oldCapacity = capacity;
+	unsigned int oldVBO = VBO;
+	if (persistent) {
+		glBindBuffer(GL_ARRAY_BUFFER, oldVBO);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		mapped = nullptr;
+	}
+
+	while (capacity < minCapacity) {
+		capacity *= 2;
+	}
+	Create();
+	Release(oldCapacity, capacity - oldCapacity);
+
+	// Ranges keep their offsets, whether in use, free or waiting for a fence, so only the contents are copied
+	glBindBuffer(GL_COPY_READ_BUFFER, oldVBO);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, VBO);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldCapacity * sizeof(uint32_t));
+	glDeleteBuffers(1, &oldVBO);	// Deleted once the draws still using it are done
+
+	// Writes through the mapping bypass the command stream, so the copy has to land before anything is uploaded
+	GLsync copied = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	while (glClientWaitSync(copied, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED) { }
+	glDeleteSync(copied);
+}
+
+bool MeshBuffer::Allocate(size_t count, size_t& first) {
+	// Next fit: the first range from the cursor on that is big enough, wrapping around once
+	auto start = freeRanges.lower_bound(cursor);
+	auto it = start;
+	for (int pass = 0; pass < 2; pass++) {
+		auto end = pass == 0 ? freeRanges.end() : start;
+		if (pass == 1) {
+			it = freeRanges.begin();
+		}
+		for (; it != end; ++it) {
+			if (it->second >= count) {
+				first = it->first;
+				size_t left = it->second - count;
+				freeRanges.erase(it);
+				if (left > 0) {
+					freeRanges[first + count] = left;
+				}
+				cursor = first + count;
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void MeshBuffer::Release(size_t first, size_t count) {
+	auto next = freeRanges.lower_bound(first);
+	if (next != freeRanges.end() && first + count == next->first) {
+		count += next->second;
+		next = freeRanges.erase(next);
+	}
+	if (next != freeRanges.begin()) {
+		auto previous = std::prev(next);
+		if (previous->first + previous->second == first) {
+			previous->second += count;
+			return;
+		}
+	}
+	freeRanges[first] = count;
+}
+
+void MeshBuffer::Reclaim(bool wait) {
+	if (wait && !freed.empty()) {
+		fenced.push_back({ glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), std::move(freed) });
+		freed.clear();
+	}
+	while (!fenced.empty()) {
+		GLenum status = glClientWaitSync(fenced.front().fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? 1000000000 : 0);
+		if (status == GL_TIMEOUT_EXPIRED) {
+			if (!wait) {
+				return;
+			}
+			continue;
+		}
+		for (std::pair<size_t, size_t>& range : fenced.front().ranges) {
+			Release(range.first, range.second);
+		}
+		glDeleteSync(fenced.front().fence);
+		fenced.pop_front();
+	}
+}
+
+void MeshBuffer::SetupVertexArray() {
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glVertexAttribIPointer(0, 1, GL_UNSIGNED_INT, Renderer::VERTEXSIZE * sizeof(uint32_t), (void*)0);	// packed vertex
+	glEnableVertexAttribArray(0);
+	if (multiDraw) {
+		glBindBuffer(GL_ARRAY_BUFFER, chunkBuffer);
+		glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)0);	// chunk origin and unit
+		glVertexAttribDivisor(1, 1);	// One per instance, and every draw is one instance with its index as base instance
+		glEnableVertexAttribArray(1);
+	}
+	glBindVertexArray(0);
+}
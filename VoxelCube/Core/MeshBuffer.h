@@ -0,0 +1,115 @@
+#pragma once
+
+/* One big vertex buffer that the chunk meshes are placed in, so streaming terrain in doesn't create a buffer per chunk
+*
+* Meshes are sub-allocated from the buffer like a ring: the search for a free range starts where the last mesh was
+* placed and wraps around at the end, so a range that was just freed is the last to be reused. A freed range can still
+* be read by frames the GPU hasn't finished, so it only becomes free once the fence of the frame it was freed in (see
+* EndFrame()) has signalled. A range that is handed out is never in use, hence uploads never wait for the GPU.
+*
+* With GL 4.4 or ARB_buffer_storage, the buffer is mapped once, persistently and coherently, and an upload is a memcpy.
+* Otherwise each upload maps just its own range with GL_MAP_INVALIDATE_RANGE_BIT, orphaning the old contents of that
+* range, and unsynchronized, as the fences already make sure the GPU is done with it. If the map fails, the upload is a
+* glBufferSubData instead.
+* When no free range is big enough, the buffer doubles and the meshes are copied over on the GPU.
+*
+* Draws are queued with AddDraw() and issued together by Draw(). With a GL 4.3 context that is a single
+* glMultiDrawElementsIndirect call. Each draw has its own chunk origin and unit (attribute 1 of VertexShader.txt) in a
+* per-instance buffer: the draw with index i has one instance with base instance i, so it reads entry i. Without it,
+* Draw() loops over the same draws, setting attribute 1 as a constant before each one.
+*/
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <utility>
+#include <vector>
+
+class MeshBuffer
+{
+public:
+	/* The capacity is in vertices. The buffer is only created on the first upload, once there is a GL context
+	Without allowMultiDraw, Draw() loops even where the multi-draw is available, so the two can be compared */
+	MeshBuffer(size_t capacity = 1 << 22, bool allowMultiDraw = true);
+	~MeshBuffer();
+
+	/* Copy the vertices into a free range of the buffer. Returns the first vertex of the range */
+	size_t Upload(const std::vector<uint32_t>& vertices);
+
+	/* Give a range back. It is reused once the frames that may draw from it are done */
+	void Free(size_t first, size_t count);
+
+	/* Queue a draw of this many faces from firstVertex on, for a mesh with this origin and unit (see
+	Renderer::SetMeshOrigin()) */
+	void AddDraw(size_t firstVertex, size_t faces, glm::vec3 origin, float unit);
+
+	/* Issue the queued draws with the shader in use, and empty the queue */
+	void Draw();
+
+	/* Call after the draws of a frame. Fences the ranges freed since the last call */
+	void EndFrame();
+
+	/* Delete the buffer and its fences. The destructor does this too, but call it while the GL context exists */
+	void Delete();
+
+	/* True if the buffer is persistently mapped, false for the fallback */
+	bool IsPersistent();
+
+	/* True if Draw() uses a single multi-draw call, false for the loop */
+	bool IsMultiDraw();
+
+	size_t Capacity();	// In vertices
+
+private:
+	unsigned int VAO = 0;
+	unsigned int VBO = 0;
+	size_t capacity;
+	bool persistent = false;
+	uint32_t* mapped = nullptr;	// The persistent mapping
+
+	size_t cursor = 0;	// Where the search for a free range starts
+	std::map<size_t, size_t> freeRanges;	// First vertex -> count. Adjacent ranges are merged
+	std::vector<std::pair<size_t, size_t>> freed;	// Ranges freed since the last EndFrame()
+
+	struct FencedRanges {
+		GLsync fence;
+		std::vector<std::pair<size_t, size_t>> ranges;
+	};
+	std::deque<FencedRanges> fenced;	// Oldest first, waiting for the GPU
+
+	struct DrawCommand {	// Layout of DrawElementsIndirectCommand
+		GLuint count;
+		GLuint instanceCount;
+		GLuint firstIndex;
+		GLint baseVertex;
+		GLuint baseInstance;
+	};
+	std::vector<DrawCommand> commands;	// Queued draws
+	std::vector<glm::vec4> chunks;		// Per queued draw: the origin, and the unit in w
+	size_t maxFaces = 0;				// Of the queued draws, for the shared index buffer
+	bool multiDraw = false;
+	bool allowMultiDraw;
+	unsigned int commandBuffer = 0;	// Only with multiDraw
+	unsigned int chunkBuffer = 0;
+
+	/* Create the buffer (and the vertex array object, the first time). Its ranges are not free yet */
+	void Create();
+
+	/* Replace the buffer by one that holds at least this many vertices, keeping the contents */
+	void Grow(size_t minCapacity);
+
+	/* Take a free range. False if none is big enough */
+	bool Allocate(size_t count, size_t& first);
+
+	/* Add a range to the free ranges */
+	void Release(size_t first, size_t count);
+
+	/* Release the ranges of the fences that have signalled. With wait, blocks until all of them have */
+	void Reclaim(bool wait);
+
+	/* Point the vertex array object at the current buffer, and at the per-draw chunk buffer with multiDraw */
+	void SetupVertexArray();
+};
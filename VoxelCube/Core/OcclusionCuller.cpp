@@ -0,0 +1,225 @@
+#include "OcclusionCuller.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// Clip space w below which a point counts as behind the eye
+static const float MINDEPTH = 1e-3f;
+
+// How far behind the occluders a box must be to be hidden, as a fraction of their depth. Keeps rounding from hiding a
+// box behind a face that lies in the same plane as its own front, such as its own occluder or a neighbor's in a wall
+static const float DEPTHBIAS = 1e-4f;
+
+// Corner i of a box is at min, with max in x if bit 0 is set, in y for bit 1 and in z for bit 2
+// Per face (-x, +x, -y, +y, -z, +z): the corners of the quad, going around it
+static const int FACE_CORNERS[6][4] = {
+	{ 0, 2, 6, 4 }, { 1, 3, 7, 5 },
+	{ 0, 1, 5, 4 }, { 2, 3, 7, 6 },
+	{ 0, 1, 3, 2 }, { 4, 5, 7, 6 },
+};
+
+OcclusionCuller::OcclusionCuller(unsigned int width, unsigned int height) {
+	this->width = 4;
+	while (this->width < width) {
+		this->width *= 2;
+	}
+	this->height = 1;
+	while (this->height < height) {
+		this->height *= 2;
+	}
+
+	for (unsigned int w = this->width, h = this->height; ; w = std::max(1U, w / 2), h = std::max(1U, h / 2)) {
+		levels.emplace_back(w * h, FLT_MAX);
+		if (w == 1 && h == 1) {
+			break;
+		}
+	}
+}
+
+void OcclusionCuller::Begin(const glm::mat4& projectionView, glm::vec3 eye) {
+	this->projectionView = projectionView;
+	this->eye = eye;
+	std::fill(levels[0].begin(), levels[0].end(), FLT_MAX);
+}
+
+void OcclusionCuller::AddOccluder(glm::vec3 min, glm::vec3 max) {
+	glm::vec3 corners[8];
+	for (int i = 0; i < 8; i++) {
+		glm::vec3 corner(i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z);
+		if (!Project(corner, corners[i])) {
+			return;
+		}
+	}
+
+	for (int face = 0; face < 6; face++) {
+		// Only the faces on the side of the eye. The others lie behind them
+		int axis = face >> 1;
+		if ((face & 1) ? eye[axis] <= max[axis] : eye[axis] >= min[axis]) {
+			continue;
+		}
+		const int* quad = FACE_CORNERS[face];
+		float depth = std::max({ corners[quad[0]].z, corners[quad[1]].z, corners[quad[2]].z, corners[quad[3]].z });
+		RasterizeQuad(corners[quad[0]], corners[quad[1]], corners[quad[2]], corners[quad[3]], depth);
+	}
+}
+
+void OcclusionCuller::BuildPyramid() {
+	unsigned int w = width;
+	unsigned int h = height;
+	for (size_t level = 1; level < levels.size(); level++) {
+		// A level of 1 texel in one direction keeps taking the max of the 2 in the other
+		unsigned int nextW = std::max(1U, w / 2);
+		unsigned int nextH = std::max(1U, h / 2);
+		const std::vector<float>& below = levels[level - 1];
+		std::vector<float>& next = levels[level];
+		for (unsigned int y = 0; y < nextH; y++) {
+			unsigned int y0 = std::min(2 * y, h - 1);
+			unsigned int y1 = std::min(2 * y + 1, h - 1);
+			for (unsigned int x = 0; x < nextW; x++) {
+				unsigned int x0 = std::min(2 * x, w - 1);
+				unsigned int x1 = std::min(2 * x + 1, w - 1);
+				next[y * nextW + x] = std::max({ below[y0 * w + x0], below[y0 * w + x1], below[y1 * w + x0], below[y1 * w + x1] });
+			}
+		}
+		w = nextW;
+		h = nextH;
+	}
+}
+
+bool OcclusionCuller::IsVisible(glm::vec3 min, glm::vec3 max) const {
+	glm::vec3 lower(FLT_MAX);
+	glm::vec3 upper(-FLT_MAX);
+	for (int i = 0; i < 8; i++) {
+		glm::vec3 corner(i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z);
+		glm::vec3 screen;
+		if (!Project(corner, screen)) {
+			return true;
+		}
+		lower = glm::min(lower, screen);
+		upper = glm::max(upper, screen);
+	}
+	if (upper.x < 0 || upper.y < 0 || lower.x >= (float)width || lower.y >= (float)height) {
+		return true;	// Off screen, that is for the frustum to decide
+	}
+
+	// The texels the rectangle touches, at the first level where that is at most 2 by 2
+	int x0 = std::max(0, (int)lower.x);
+	int y0 = std::max(0, (int)lower.y);
+	int x1 = std::min((int)width - 1, (int)upper.x);
+	int y1 = std::min((int)height - 1, (int)upper.y);
+	size_t level = 0;
+	unsigned int levelWidth = width;
+	while ((x1 - x0 > 1 || y1 - y0 > 1) && level + 1 < levels.size()) {
+		level++;
+		levelWidth = std::max(1U, levelWidth / 2);
+		x0 >>= 1;
+		y0 >>= 1;
+		x1 >>= 1;
+		y1 >>= 1;
+	}
+	x1 = std::min(x1, (int)levelWidth - 1);
+	x0 = std::min(x0, x1);
+	unsigned int levelHeight = (unsigned int)(levels[level].size() / levelWidth);
+	y1 = std::min(y1, (int)levelHeight - 1);
+	y0 = std::min(y0, y1);
+
+	float farthest = 0;
+	for (int y = y0; y <= y1; y++) {
+		for (int x = x0; x <= x1; x++) {
+			farthest = std::max(farthest, levels[level][y * levelWidth + x]);
+		}
+	}
+	return lower.z <= farthest * (1.0f + DEPTHBIAS);
+}
+
+unsigned int OcclusionCuller::Width() {
+	return width;
+}
+
+unsigned int OcclusionCuller::Height() {
+	return height;
+}
+
+float OcclusionCuller::GetDepth(unsigned int x, unsigned int y) {
+	return levels[0][y * width + x];
+}
+
+bool OcclusionCuller::Project(glm::vec3 point, glm::vec3& screen) const {
+	glm::vec4 clip = projectionView * glm::vec4(point, 1.0f);
+	if (clip.w < MINDEPTH) {
+		return false;
+	}
+	screen = glm::vec3((clip.x / clip.w * 0.5f + 0.5f) * (float)width, (clip.y / clip.w * 0.5f + 0.5f) * (float)height, clip.w);
+	return true;
+}
+
+void OcclusionCuller::RasterizeQuad(glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d, float depth) {
+	// Edge functions, positive on the inside whichever way the quad winds. It is the projection of a face that lies
+	// in front of the eye, so it is convex
+	float area = (c.x - a.x) * (d.y - b.y) - (c.y - a.y) * (d.x - b.x);
+	if (area == 0) {
+		return;
+	}
+	float sign = area > 0 ? 1.0f : -1.0f;
+	const glm::vec3* from[4] = { &a, &b, &c, &d };
+	const glm::vec3* to[4] = { &b, &c, &d, &a };
+	float stepX[4], stepY[4], offset[4];	// e(x, y) = stepX * x + stepY * y + offset
+	for (int i = 0; i < 4; i++) {
+		stepX[i] = sign * (from[i]->y - to[i]->y);
+		stepY[i] = sign * (to[i]->x - from[i]->x);
+		// Moved inwards by half a pixel on both axes, so a pixel center is only inside if the whole pixel is
+		offset[i] = -(stepX[i] * from[i]->x + stepY[i] * from[i]->y) - 0.5f * (std::abs(stepX[i]) + std::abs(stepY[i]));
+	}
+
+	// Pixel centers in the bounding box. Rows start on a multiple of 4 pixels, the width is one too
+	float minX = std::min({ a.x, b.x, c.x, d.x });
+	float maxX = std::max({ a.x, b.x, c.x, d.x });
+	float minY = std::min({ a.y, b.y, c.y, d.y });
+	float maxY = std::max({ a.y, b.y, c.y, d.y });
+	int x0 = std::max(0, (int)std::floor(minX - 0.5f)) & ~3;
+	int x1 = std::min((int)width, (int)std::ceil(maxX + 0.5f));
+	int y0 = std::max(0, (int)std::floor(minY - 0.5f));
+	int y1 = std::min((int)height, (int)std::ceil(maxY + 0.5f));
+	if (x0 >= x1 || y0 >= y1) {
+		return;
+	}
+
+	for (int y = y0; y < y1; y++) {
+		float* row = levels[0].data() + (size_t)y * width;
+		float centerY = (float)y + 0.5f;
+		float e[4];
+		for (int i = 0; i < 4; i++) {
+			e[i] = stepX[i] * ((float)x0 + 0.5f) + stepY[i] * centerY + offset[i];
+		}
+#if OCCLUSION_USE_SSE2
+		const __m128 LANES = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+		__m128 edge[4], step[4];
+		for (int i = 0; i < 4; i++) {
+			edge[i] = _mm_add_ps(_mm_set1_ps(e[i]), _mm_mul_ps(LANES, _mm_set1_ps(stepX[i])));
+			step[i] = _mm_set1_ps(4.0f * stepX[i]);
+		}
+		const __m128 ZERO = _mm_setzero_ps();
+		const __m128 DEPTH = _mm_set1_ps(depth);
+		const __m128 FAR = _mm_set1_ps(FLT_MAX);
+		for (int x = x0; x < x1; x += 4) {
+			__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(edge[0], ZERO), _mm_cmpge_ps(edge[1], ZERO)),
+				_mm_and_ps(_mm_cmpge_ps(edge[2], ZERO), _mm_cmpge_ps(edge[3], ZERO)));
+			// The depth where covered, the farthest depth elsewhere, so the min only changes covered pixels
+			__m128 value = _mm_or_ps(_mm_and_ps(inside, DEPTH), _mm_andnot_ps(inside, FAR));
+			_mm_storeu_ps(row + x, _mm_min_ps(_mm_loadu_ps(row + x), value));
+			for (int i = 0; i < 4; i++) {
+				edge[i] = _mm_add_ps(edge[i], step[i]);
+			}
+		}
+#else
+		for (int x = x0; x < x1; x++) {
+			if (e[0] >= 0 && e[1] >= 0 && e[2] >= 0 && e[3] >= 0) {
+				row[x] = std::min(row[x], depth);
+			}
+			for (int i = 0; i < 4; i++) {
+				e[i] += stepX[i];
+			}
+		}
+#endif
+	}
+}
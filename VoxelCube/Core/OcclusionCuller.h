@@ -0,0 +1,69 @@
+#pragma once
+
+/* Software occlusion culling with a hierarchical depth buffer (Hi-Z), on the CPU only
+*
+* Every frame, Begin() clears a small depth buffer, AddOccluder() rasterizes the front faces of solid boxes into it,
+* nearest first, and BuildPyramid() makes the Hi-Z pyramid: each level holds the farthest depth of 2x2 texels of the
+* level below. IsVisible() then projects a box, picks the level where its screen rectangle spans at most 2x2 texels,
+* and finds the box hidden if its nearest point is behind the farthest depth in all of them.
+*
+* Depth is the clip space w, the distance along the view direction, so it is linear and needs no near or far plane.
+* Occluders are conservative in depth: a face is written at the depth of its farthest corner. They are conservative in
+* coverage as well: the edges of a face are moved inwards by half a pixel, so only the pixels it covers all of are
+* written. Pixels on the seam between two faces are left open, even where the faces cover them together.
+* A box is hidden only if it is behind the occluders by a small bias, so the face of an occluder in the same plane as
+* the box's front (the box's own, or a neighbor's in a wall) never hides it.
+* A box that reaches behind the eye is never used as an occluder, and never culled.
+*
+* Faces are rasterized 4 pixels at a time with SSE2 where the target has it (every x64 target does), otherwise
+* one pixel at a time. Nothing here touches GL, so it can be used and tested without a context.
+*/
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OCCLUSION_USE_SSE2 1
+#include <emmintrin.h>
+#else
+#define OCCLUSION_USE_SSE2 0
+#endif
+
+class OcclusionCuller
+{
+public:
+	/* The size of the depth buffer in pixels. Both are rounded up to a power of two, and the width to at least 4 */
+	OcclusionCuller(unsigned int width = 256, unsigned int height = 128);
+
+	/* Clear the depth buffer, for a frame seen from the eye through projection * view */
+	void Begin(const glm::mat4& projectionView, glm::vec3 eye);
+
+	/* Rasterize the faces of a solid box that face the eye */
+	void AddOccluder(glm::vec3 min, glm::vec3 max);
+
+	/* Build the pyramid from the depth buffer. Call after the last occluder, before IsVisible() */
+	void BuildPyramid();
+
+	/* False if the box is hidden behind the occluders */
+	bool IsVisible(glm::vec3 min, glm::vec3 max) const;
+
+	unsigned int Width();
+	unsigned int Height();
+
+	/* Depth of a pixel of the depth buffer, the farthest depth for pixels without an occluder */
+	float GetDepth(unsigned int x, unsigned int y);
+
+private:
+	unsigned int width;
+	unsigned int height;
+	glm::mat4 projectionView = glm::mat4(1.0f);
+	glm::vec3 eye = glm::vec3(0.0f);
+	std::vector<std::vector<float>> levels;	// Level 0 is the depth buffer, each next one half the size
+
+	/* Position in pixels and depth (the clip space w) of a point. False if it lies behind the eye */
+	bool Project(glm::vec3 point, glm::vec3& screen) const;
+
+	/* Rasterize a convex quad in pixels, keeping the nearest depth. Only the pixels it covers all of */
+	void RasterizeQuad(glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d, float depth);
+};
@@ -1,149 +1,210 @@
 #include "Renderer.h"
+#include <cstring>
 
 Renderer::Renderer() {
     //Renderer::vertexArray = {};
 }
 
-void Renderer::StageMesh(unsigned int VAO, unsigned int VBO) {
-    this->VAO = VAO;
-    this->VBO = VBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
+void Renderer::UploadMesh() {
+    if (this->VAO == 0) {
+        glGenVertexArrays(1, &this->VAO);
+        glGenBuffers(1, &this->VBO);
+        glBindVertexArray(this->VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+        glVertexAttribIPointer(0, 1, GL_UNSIGNED_INT, Renderer::VERTEXSIZE * sizeof(uint32_t), (void*)0);
+        glEnableVertexAttribArray(0);
+    }
+    else {
+        glBindVertexArray(this->VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+    }
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, this->vertexArray.size() * sizeof(int), &(this->vertexArray)[0], GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, this->vertexArray.size() * sizeof(uint32_t), this->vertexArray.data(), GL_STATIC_DRAW);
+    BindQuadIndices(this->vertexArray.size() / Renderer::FACESIZE);
+    glBindVertexArray(0);
+}
 
-    glBindVertexArray(VAO);
-    glVertexAttribPointer(0, 3, GL_INT, GL_FALSE, 6 * sizeof(int), (void*)0);    // position
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_INT, GL_TRUE, 6 * sizeof(int), (void*)(3 * sizeof(int)));    // normals
-    glEnableVertexAttribArray(1);
+// One face per visibility bit, from bit 5 down to bit 0: -x, +x, -y, +y, -z, +z. The index is the packed face id
+// Each face is a quad, drawn as the triangles (0, 1, 2) and (2, 3, 0). Per vertex: the corner, as offsets of 0 or 1
+// cube widths. The corners are ordered so both triangles face outwards
+static const uint8_t FACE_TEMPLATES[6][4][3] = {
+    { { 0, 1, 1 }, { 0, 1, 0 }, { 0, 0, 0 }, { 0, 0, 1 } },
+    { { 1, 0, 0 }, { 1, 1, 0 }, { 1, 1, 1 }, { 1, 0, 1 } },
+    { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 0, 1 }, { 0, 0, 1 } },
+    { { 1, 1, 1 }, { 1, 1, 0 }, { 0, 1, 0 }, { 0, 1, 1 } },
+    { { 1, 1, 0 }, { 1, 0, 0 }, { 0, 0, 0 }, { 0, 1, 0 } },
+    { { 0, 0, 1 }, { 1, 0, 1 }, { 1, 1, 1 }, { 0, 1, 1 } },
+};
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-}
+// Shared by every mesh, as the indices only depend on the number of faces
+unsigned int Renderer::quadIndexBuffer = 0;
+size_t Renderer::quadIndexFaces = 0;
 
-void Renderer::CreateCube(uint32_t x, uint32_t y, uint32_t z, uint32_t width, uint8_t visibility) {
-    // TODO: Separate the normals and positions to use int and unsigned ints separately
-    // TODO: Also need to add color data(!)
-    int X = (int)x;
-    int Y = (int)y;
-    int Z = (int)z;
-    int WIDTH = (int)width;
-    
-    std::vector<int> vertices = {
-        // positions (3)        normals (3)
-        X,      Y+WIDTH,Z+WIDTH,-1, 0, 0,
-        X,      Y+WIDTH,Z,      -1, 0, 0,
-        X,      Y,      Z,      -1, 0, 0,
-        X,      Y,      Z,      -1, 0, 0,
-        X,      Y,      Z+WIDTH,-1, 0, 0,
-        X,      Y+WIDTH,Z+WIDTH,-1, 0, 0,
-
-        X+WIDTH,Y+WIDTH,Z+WIDTH,1, 0, 0,
-        X+WIDTH,Y,      Z,      1, 0, 0,
-        X+WIDTH,Y+WIDTH,Z,      1, 0, 0,
-        X+WIDTH,Y,      Z,      1, 0, 0,
-        X+WIDTH,Y+WIDTH,Z+WIDTH,1, 0, 0,
-        X+WIDTH,Y,      Z+WIDTH,1, 0, 0,
-
-        X,      Y,      Z,      0, -1, 0,
-        X+WIDTH,Y,      Z,      0, -1, 0,
-        X+WIDTH,Y,      Z+WIDTH,0, -1, 0,
-        X+WIDTH,Y,      Z+WIDTH,0, -1, 0,
-        X,      Y,      Z+WIDTH,0, -1, 0,
-        X,      Y,      Z,      0, -1, 0,
-
-        X,      Y+WIDTH,Z,      0, 1, 0,
-        X+WIDTH,Y+WIDTH,Z+WIDTH,0, 1, 0,
-        X+WIDTH,Y+WIDTH,Z,      0, 1, 0,
-        X+WIDTH,Y+WIDTH,Z+WIDTH,0, 1, 0,
-        X,      Y+WIDTH,Z,      0, 1, 0,
-        X,      Y+WIDTH,Z+WIDTH,0, 1, 0,
-
-        X,      Y,      Z,      0, 0, -1,
-        X+WIDTH,Y+WIDTH,Z,      0, 0, -1,
-        X+WIDTH,Y,      Z,      0, 0, -1,
-        X+WIDTH,Y+WIDTH,Z,      0, 0, -1,
-        X,      Y,      Z,      0, 0, -1,
-        X,      Y+WIDTH,Z,      0, 0, -1,
-
-        X,      Y,      Z+WIDTH,0, 0, 1,
-        X+WIDTH,Y,      Z+WIDTH,0, 0, 1,
-        X+WIDTH,Y+WIDTH,Z+WIDTH,0, 0, 1,
-        X+WIDTH,Y+WIDTH,Z+WIDTH,0, 0, 1,
-        X,      Y+WIDTH,Z+WIDTH,0, 0, 1,
-        X,      Y,      Z+WIDTH,0, 0, 1,
-    };
+// Shared by every program, see BlockShader::FRAME_BINDING
+unsigned int Renderer::frameUniformBuffer = 0;
+Renderer::FrameUniforms Renderer::frameUniforms = {};
 
-    // All faces visibile
-    if ((visibility >> 7) & 1U) {
-        this->vertexArray.insert(this->vertexArray.end(), vertices.begin(), vertices.end());
+void Renderer::CreateCube(uint32_t x, uint32_t y, uint32_t z, uint32_t width, uint8_t visibility, uint16_t type) {
+    // TODO: Also need to add color data(!)
+    uint8_t faces = FaceCount(visibility);
+    if (faces == 0) {
         return;
     }
-    // No faces visible
-    if (!((visibility >> 6) & 1U)) {
-        return;
+    // Local position and width, in mesh units
+    const uint32_t corner[3] = {
+        (x - meshOrigin.x) >> meshUnitShift,
+        (y - meshOrigin.y) >> meshUnitShift,
+        (z - meshOrigin.z) >> meshUnitShift,
+    };
+    const uint32_t WIDTH = width >> meshUnitShift;
+
+    // Grow in place and write straight into the array. Doesn't allocate if ReserveFaces() made room
+    size_t end = this->vertexArray.size();
+    this->vertexArray.resize(end + faces * Renderer::FACESIZE);
+    uint32_t* out = this->vertexArray.data() + end;
+
+    for (uint8_t face = 0; face < 6; face++) {
+        if (!((visibility >> (5 - face)) & 1U)) {
+            continue;
+        }
+        for (int vertex = 0; vertex < 4; vertex++) {
+            const uint8_t* v = FACE_TEMPLATES[face][vertex];
+            *out = PackVertex(corner[0] + v[0] * WIDTH, corner[1] + v[1] * WIDTH, corner[2] + v[2] * WIDTH, face, type);
+            out += Renderer::VERTEXSIZE;
+        }
     }
-    // Front x
-    if ((visibility >> 5) & 1U) {
-        this->vertexArray.insert(this->vertexArray.end(), vertices.begin() + 0, vertices.begin() + 36);
+}
+
+void Renderer::CreateFace(uint8_t face, uint32_t x, uint32_t y, uint32_t z, uint32_t sizeX, uint32_t sizeY, uint32_t sizeZ, uint16_t type) {
+    size_t end = this->vertexArray.size();
+    this->vertexArray.resize(end + Renderer::FACESIZE);
+    uint32_t* out = this->vertexArray.data() + end;
+
+    for (int vertex = 0; vertex < 4; vertex++) {
+        const uint8_t* v = FACE_TEMPLATES[face][vertex];
+        *out = PackVertex(x + v[0] * sizeX, y + v[1] * sizeY, z + v[2] * sizeZ, face, type);
+        out += Renderer::VERTEXSIZE;
     }
-    // Back x
-    if ((visibility >> 4) & 1U) {
-        this->vertexArray.insert(this->vertexArray.end(), vertices.begin() + 36, vertices.begin() + 72);
+}
+
+uint32_t Renderer::PackVertex(uint32_t x, uint32_t y, uint32_t z, uint8_t face, uint16_t type) {
+    return x | (y << 6) | (z << 12) | ((uint32_t)face << 18) | ((uint32_t)type << 21);
+}
+
+void Renderer::UnpackVertex(uint32_t vertex, uint32_t& x, uint32_t& y, uint32_t& z, uint8_t& face, uint16_t& type) {
+    x = vertex & 63U;
+    y = (vertex >> 6) & 63U;
+    z = (vertex >> 12) & 63U;
+    face = (vertex >> 18) & 7U;
+    type = (uint16_t)(vertex >> 21);
+}
+
+glm::u32vec3 Renderer::GetMeshOrigin() {
+    return meshOrigin;
+}
+
+uint32_t Renderer::GetMeshUnit() {
+    return meshUnit;
+}
+
+void Renderer::SetMeshOrigin(glm::u32vec3 origin, uint32_t unit) {
+    meshOrigin = origin;
+    meshUnit = unit;
+    meshUnitShift = 0;
+    while ((1U << meshUnitShift) < unit) {
+        meshUnitShift++;
     }
-    // Front y
-    if ((visibility >> 3) & 1U) {
-        this->vertexArray.insert(this->vertexArray.end(), vertices.begin() + 72, vertices.begin() + 108);
+}
+
+void Renderer::BindQuadIndices(size_t faces) {
+    if (quadIndexBuffer == 0) {
+        glGenBuffers(1, &quadIndexBuffer);
     }
-    // Back y
-    if ((visibility >> 2) & 1U) {
-        this->vertexArray.insert(this->vertexArray.end(), vertices.begin() + 108, vertices.begin() + 144);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadIndexBuffer);
+    if (faces <= quadIndexFaces) {
+        return;
     }
-    // Front z
-    if ((visibility >> 1) & 1U) {
-        this->vertexArray.insert(this->vertexArray.end(), vertices.begin() + 144, vertices.begin() + 180);
+
+    // Grow to the next power of two, so a slowly growing world doesn't re-upload every time
+    size_t capacity = 1024;
+    while (capacity < faces) {
+        capacity *= 2;
     }
-    // Back z
-    if ((visibility >> 0) & 1U) {
-        this->vertexArray.insert(this->vertexArray.end(), vertices.begin() + 180, vertices.begin() + 216);
+    static const uint32_t QUAD[6] = { 0, 1, 2, 2, 3, 0 };
+    std::vector<uint32_t> indices(capacity * 6);
+    for (size_t face = 0; face < capacity; face++) {
+        for (int i = 0; i < 6; i++) {
+            indices[face * 6 + i] = (uint32_t)(face * 4) + QUAD[i];
+        }
     }
+    // Same buffer name, so the VAOs that already use it stay valid
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.data(), GL_STATIC_DRAW);
+    quadIndexFaces = capacity;
+}
 
+void Renderer::ReserveFaces(size_t faces) {
+    this->vertexArray.reserve(this->vertexArray.size() + faces * Renderer::FACESIZE);
+}
 
-	return;
-};
+uint8_t Renderer::FaceCount(uint8_t visibility) {
+    // The all faces and at least one face bits are kept in sync with the face bits, so only the face bits count
+    uint8_t faces = visibility & 63U;
+    faces = faces - ((faces >> 1) & 0x55);
+    faces = (faces & 0x33) + ((faces >> 2) & 0x33);
+    return (faces + (faces >> 4)) & 0x0F;
+}
 
 void Renderer::RenderMesh(BlockShader * shader, Camera camera, const unsigned int WIDTH, const unsigned int HEIGHT) {
+    UseShader(shader, camera, WIDTH, HEIGHT);
+    DrawMesh();
+}
+
+glm::mat4 Renderer::ProjectionMatrix(Camera camera, const unsigned int WIDTH, const unsigned int HEIGHT) {
+    return glm::perspective(glm::radians(camera.Zoom), (float)WIDTH / (float)HEIGHT, 0.1f, 10000.0f);
+}
+
+void Renderer::UseShader(BlockShader* shader, Camera camera, const unsigned int WIDTH, const unsigned int HEIGHT) {
     // be sure to activate shader when setting uniforms/drawing objects
     shader->use();
-    shader->setVec3("objectColor", 1.0f, 0.8f, 0.5f);
-    shader->setVec3("lightColor", 1.0f, 1.0f, 1.0f);
-    shader->setVec3("light.direction", -0.2f, -1.0f, -0.3f);
-    shader->setVec3("light.ambient", 0.2f, 0.2f, 0.2f);
-    shader->setVec3("light.diffuse", 0.5f, 0.5f, 0.5f);
-    shader->setVec3("light.specular", 1.0f, 1.0f, 1.0f);
-    shader->setFloat("material.shininess", 32.0f);
-    shader->setInt("material.diffuse", 0);
-    shader->setInt("material.specular", 1);
-
-    // view/projection transformations
-    glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)WIDTH / (float)HEIGHT, 0.1f, 10000.0f);
-    glm::mat4 view = camera.GetViewMatrix();
-    shader->setMat4("projection", projection);
-    shader->setMat4("view", view);
-    shader->setVec3("viewPos", camera.Position);
-
-
-    // world transformation
-    glm::mat4 model = glm::mat4(1.0f);
-    shader->setMat4("model", model);
+
+    // view/projection transformations, light and material
+    FrameUniforms frame = {};
+    frame.projection = ProjectionMatrix(camera, WIDTH, HEIGHT);
+    frame.view = camera.GetViewMatrix();
+    frame.viewPos = glm::vec4(camera.Position, 1.0f);
+    frame.lightDirection = glm::vec4(-0.2f, -1.0f, -0.3f, 0.0f);
+    frame.lightAmbient = glm::vec4(0.2f, 0.2f, 0.2f, 1.0f);
+    frame.lightDiffuse = glm::vec4(0.5f, 0.5f, 0.5f, 1.0f);
+    frame.lightSpecular = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+    frame.objectColor = glm::vec4(1.0f, 0.8f, 0.5f, 1.0f);
+    frame.shininess = 32.0f;
+
+    // Every program reads the same buffer, so the other programs and meshes drawn this frame find it up to date
+    if (frameUniformBuffer == 0) {
+        glGenBuffers(1, &frameUniformBuffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, frameUniformBuffer);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), &frame, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, BlockShader::FRAME_BINDING, frameUniformBuffer);
+    }
+    else if (std::memcmp(&frame, &frameUniforms, sizeof(FrameUniforms)) != 0) {
+        glBindBuffer(GL_UNIFORM_BUFFER, frameUniformBuffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &frame);
+    }
+    frameUniforms = frame;
+}
+
+void Renderer::DrawMesh() {
+    // where the packed vertex positions are relative to. The attribute has no array enabled in this VAO
+    glVertexAttrib4f(1, (float)meshOrigin.x, (float)meshOrigin.y, (float)meshOrigin.z, (float)meshUnit);
 
     // render the cube
     glBindVertexArray(this->VAO);
-    glDrawArrays(GL_TRIANGLES, 0, this->vertexArray.size());
+    glDrawElements(GL_TRIANGLES, (GLsizei)(this->vertexArray.size() / Renderer::FACESIZE * 6), GL_UNSIGNED_INT, (void*)0);
 }
 
 void Renderer::UnbindMesh() {
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
+    VAO = 0;
+    VBO = 0;
 }
@@ -8,22 +8,96 @@ class Renderer
 public:
 	Renderer();
 
-	/* TODO: Allow several of these (in an array perhaps?) to prevent risk of multiple access and allow multithreading */
-	std::vector<int> vertexArray;
+	/* One packed vertex per element, see PackVertex(). Meshing fills this only, so every meshing job can fill a
+	Renderer of its own (see ChunkManager) */
+	std::vector<uint32_t> vertexArray;
 
-	/* Stages the VAO and VBO for a voxel mesh with **size** triangles */
-	void StageMesh(unsigned int VAO, unsigned int VBO);
+	/* Upload the vertex array, creating the VAO and VBO the first time. Call again after the mesh changed, to replace
+	the data in the same buffers */
+	void UploadMesh();
 
-	/* Adds a cube to the vertex array. Visibility is the visibility bitmap defined in Octree.h */
-	void CreateCube(uint32_t x, uint32_t y, uint32_t z, uint32_t width, uint8_t visibility);
+	static const size_t VERTEXSIZE = 1;				// Words per vertex, see PackVertex()
+	static const size_t FACESIZE = 4 * VERTEXSIZE;	// Words per face: a quad, see BindQuadIndices()
 
-	/* For now, does multiple things. TODO: Split this up into smaller bits */
+	/* A mesh spans at most 2^MESHDEPTH units per axis from its origin, as that is what fits in a packed vertex */
+	static const uint32_t MESHDEPTH = 5;
+
+	/* Pack a vertex into a single word. Bits 0-5, 6-11 and 12-17 hold the position in units relative to the mesh origin
+	(0 to 32 inclusive, a corner can lie on the far side of the box), bits 18-20 the face (0 to 5 for -x, +x, -y, +y,
+	-z, +z, which also gives the normal) and bits 21-31 the block type. VertexShader.txt decodes it the same way */
+	static uint32_t PackVertex(uint32_t x, uint32_t y, uint32_t z, uint8_t face, uint16_t type);
+
+	/* Inverse of PackVertex() */
+	static void UnpackVertex(uint32_t vertex, uint32_t& x, uint32_t& y, uint32_t& z, uint8_t& face, uint16_t& type);
+
+	/* Set where the packed positions of the mesh are relative to: the world position of local (0, 0, 0) and the world
+	size of one unit, which must be a power of two. Set before adding cubes, as it is not applied retroactively */
+	void SetMeshOrigin(glm::u32vec3 origin, uint32_t unit);
+	glm::u32vec3 GetMeshOrigin();
+	uint32_t GetMeshUnit();
+
+	/* Adds a cube to the vertex array. Visibility is the visibility bitmap defined in Octree.h
+	Only the visible faces are written, from static per-face templates, so this allocates nothing if there is room
+	The position and width are in world units, and have to be multiples of the mesh unit within the mesh box */
+	void CreateCube(uint32_t x, uint32_t y, uint32_t z, uint32_t width, uint8_t visibility, uint16_t type = 0);
+
+	/* Adds one face (0 to 5, as in PackVertex()) of the box at x, y, z with the given size. All in mesh units, unlike
+	CreateCube(). Used for faces that span several blocks, such as the rectangles of the greedy mesher */
+	void CreateFace(uint8_t face, uint32_t x, uint32_t y, uint32_t z, uint32_t sizeX, uint32_t sizeY, uint32_t sizeZ, uint16_t type);
+
+	/* Make room in the vertex array for this many more faces, so CreateCube() never has to grow it */
+	void ReserveFaces(size_t faces);
+
+	/* Number of faces CreateCube() writes for a visibility bitmap */
+	static uint8_t FaceCount(uint8_t visibility);
+
+	/* For now, does multiple things: UseShader(), then DrawMesh() */
 	void RenderMesh(BlockShader * shader, Camera camera, const unsigned int WIDTH, const unsigned int HEIGHT);
 
+	/* The projection matrix UseShader() sets for the camera */
+	static glm::mat4 ProjectionMatrix(Camera camera, const unsigned int WIDTH, const unsigned int HEIGHT);
+
+	/* Activate the shader and update what is the same for every mesh: camera, light and material. Those live in the
+	Frame uniform block that every program shares (see FrameUniforms), which is only uploaded when it changed */
+	static void UseShader(BlockShader* shader, Camera camera, const unsigned int WIDTH, const unsigned int HEIGHT);
+
+	/* Draw the staged mesh with the shader in use. Only sets the origin and unit of this mesh, as a constant value of
+	the chunk attribute (see MeshBuffer) */
+	void DrawMesh();
+
 	/* Unbind VAO and VBO */
 	void UnbindMesh();
+
+	/* Bind the index buffer that turns every 4 vertices into 2 triangles, growing it to at least this many faces
+	There is one for all meshes, as the indices are the same for every mesh */
+	static void BindQuadIndices(size_t faces);
 private:
-	// TODO: Allow multithreading for this as well
-	unsigned int VAO;
-	unsigned int VBO;
+	// Only touched on the thread with the GL context
+	unsigned int VAO = 0;
+	unsigned int VBO = 0;
+
+	static unsigned int quadIndexBuffer;
+	static size_t quadIndexFaces;	// Number of faces the index buffer holds
+
+	/* The Frame uniform block of the shaders, in its std140 layout. Its vec3s are vec4s, so there is no padding but
+	the explicit one at the end. Keep in sync with VertexShader.txt and FragmentShader.txt */
+	struct FrameUniforms {
+		glm::mat4 projection;
+		glm::mat4 view;
+		glm::vec4 viewPos;
+		glm::vec4 lightDirection;
+		glm::vec4 lightAmbient;
+		glm::vec4 lightDiffuse;
+		glm::vec4 lightSpecular;
+		glm::vec4 objectColor;
+		float shininess;
+		float padding[3];
+	};
+	static_assert(sizeof(FrameUniforms) == 240, "FrameUniforms should match the std140 layout of the Frame block");
+	static unsigned int frameUniformBuffer;	// Bound to BlockShader::FRAME_BINDING
+	static FrameUniforms frameUniforms;		// What it holds
+
+	glm::u32vec3 meshOrigin = glm::u32vec3(0);
+	uint32_t meshUnit = 1;
+	uint32_t meshUnitShift = 0;	// log2(meshUnit)
 };
@@ -0,0 +1,72 @@
+#include "WorkerPool.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool(unsigned int threads) {
+	if (threads == 0) {
+		threads = std::max(1U, std::thread::hardware_concurrency());
+	}
+	for (unsigned int i = 0; i < threads; i++) {
+		this->threads.emplace_back(&WorkerPool::Run, this, i);
+	}
+}
+
+WorkerPool::~WorkerPool() {
+	Wait();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+}
+
+void WorkerPool::Start(size_t count, std::function<void(size_t, unsigned int)> job) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		this->job = std::move(job);
+		jobCount = count;
+		nextJob.store(0, std::memory_order_relaxed);
+		busy.store((unsigned int)threads.size(), std::memory_order_relaxed);
+		batch++;
+	}
+	wake.notify_all();
+}
+
+bool WorkerPool::Done() {
+	return busy.load(std::memory_order_acquire) == 0;
+}
+
+void WorkerPool::Wait() {
+	std::unique_lock<std::mutex> lock(mutex);
+	idle.wait(lock, [this] { return Done(); });
+}
+
+unsigned int WorkerPool::ThreadCount() {
+	return (unsigned int)threads.size();
+}
+
+void WorkerPool::Run(unsigned int worker) {
+	uint64_t seenBatch = 0;
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [&] { return stopping || batch != seenBatch; });
+			if (stopping) {
+				return;
+			}
+			seenBatch = batch;
+		}
+
+		for (size_t i = nextJob.fetch_add(1, std::memory_order_relaxed); i < jobCount; i = nextJob.fetch_add(1, std::memory_order_relaxed)) {
+			job(i, worker);
+		}
+
+		// The last one out wakes Wait(). Taking the lock first makes sure the waiter is either asleep or sees busy at 0
+		if (busy.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			std::lock_guard<std::mutex> lock(mutex);
+			idle.notify_all();
+		}
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+/* A fixed set of worker threads that run batches of jobs
+*
+* Start() hands out the jobs 0 to count - 1 of a batch. Workers take the next job with an atomic counter, so there is
+* no queue to lock and a slow job doesn't hold the others up. The job also gets the index of the worker running it,
+* to pick per-thread scratch space. Only one batch runs at a time.
+*/
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkerPool
+{
+public:
+	/* 0 threads means one per hardware thread */
+	WorkerPool(unsigned int threads = 0);
+	~WorkerPool();
+
+	/* Start running job(i, worker) for every i below count, and return right away. The previous batch must be done */
+	void Start(size_t count, std::function<void(size_t, unsigned int)> job);
+
+	/* True once every job of the batch has returned */
+	bool Done();
+
+	/* Block until Done() */
+	void Wait();
+
+	unsigned int ThreadCount();
+
+private:
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable wake;	// Signals a new batch, or stopping
+	std::condition_variable idle;	// Signals that the last worker finished the batch
+	bool stopping = false;
+	uint64_t batch = 0;				// Number of batches started
+
+	std::function<void(size_t, unsigned int)> job;
+	size_t jobCount = 0;
+	std::atomic<size_t> nextJob{ 0 };
+	std::atomic<unsigned int> busy{ 0 };	// Workers still on the current batch
+
+	void Run(unsigned int worker);
+};
@@ -18,6 +18,8 @@
 #include "Core/EntityCoordinator.h"
 #include "Core/BlockShader.cpp"
 #include "World/Octree.h"
+#include "World/CompactOctree.h"
+#include "ChunkManager.h"
 
 // Input callbacks, mainly navigation and window-related
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
@@ -45,6 +47,9 @@ glm::vec3 lightPos(1.2f, 1.0f, 2.0f);
 // Renderer
 Renderer grenderer;
 
+// Keep the world in a CompactOctree instead. It has no DAG, chunks or LOD, so the world is then a single mesh
+const bool USE_COMPACT_OCTREE = false;
+
 int main() {
     // Initialize window
     glfwInit();
@@ -104,10 +109,34 @@ int main() {
     gWorld.InsertNode((uint32_t)(pow(2, 24) + pow(2, 9)), color);    // 000...01100111
     gWorld.InsertNode((uint32_t)(pow(2, 21) + pow(2, 12)), color);    // 000...01100111
     */
-    gWorld.InsertRandomNodes(&grenderer, 6);
+    // Only made when used, the game runs on gWorld otherwise
+    CompactOctree* gCompactWorld = nullptr;
+    if (USE_COMPACT_OCTREE)
+    {
+        gCompactWorld = new CompactOctree();
+        gCompactWorld->InsertRandomNodes(&grenderer, 6);
+        gCompactWorld->CreateMesh(&grenderer, (uint32_t)(1), 4);
+        gCompactWorld->StageMesh(&grenderer);
+        std::cout << "Compact world of " << gCompactWorld->NodeCount() << " nodes in "
+            << gCompactWorld->MemoryUsage() / 1024 << " KB" << std::endl;
+    }
+    else
+    {
+        gWorld.InsertRandomNodes(&grenderer, 6);
+
+        DAGStats dagStats = gWorld.CompressToDAG();
+        std::cout << "Compressed world from " << dagStats.nodesBefore << " to " << dagStats.nodesAfter << " nodes ("
+            << dagStats.bytesSaved / 1024 << " KB saved)" << std::endl;
+    }
 
-    gWorld.CreateMesh(&grenderer, (uint32_t)(1), 4);
-    gWorld.StageMesh(&grenderer);
+    // One mesh per chunk, after this only the chunks that are edited get rebuilt. Empty with the compact world
+    ChunkManager chunkManager(&gWorld);
+    auto meshStart = std::chrono::steady_clock::now();
+    chunkManager.Update(camera.Position);
+    std::chrono::duration<double> meshTime = std::chrono::steady_clock::now() - meshStart;
+    size_t meshFaces = chunkManager.FaceCount();
+    std::cout << "Meshed " << meshFaces << " faces in " << chunkManager.ChunkCount() << " chunks in "
+        << meshTime.count() * 1000.0 << " ms (" << meshFaces / meshTime.count() << " faces/s)" << std::endl;
 
     /******************
      * MAIN GAME LOOP *
@@ -167,14 +196,23 @@ int main() {
         glClearColor(0.20f, 0.78f, 0.94f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        gWorld.Render(&grenderer, camera, SCR_WIDTH, SCR_HEIGHT);
+        if (USE_COMPACT_OCTREE)
+        {
+            gCompactWorld->Render(&grenderer, camera, SCR_WIDTH, SCR_HEIGHT);
+        }
+        else
+        {
+            chunkManager.Update(camera.Position);
+            chunkManager.Render(camera, SCR_WIDTH, SCR_HEIGHT);
+        }
 
         // Swap buffers
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
 
-    grenderer.UnbindMesh();
+    chunkManager.UnbindMeshes();
+    delete gCompactWorld;
 
     glfwTerminate();
     return 0;
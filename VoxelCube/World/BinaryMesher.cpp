@@ -0,0 +1,149 @@
+#include "BinaryMesher.h"
+#include "Morton.h"
+#include <algorithm>
+
+BinaryMesher::BinaryMesher() {
+	columns.resize(3 * SIZE * SIZE, 0);
+	types.resize(SIZE * SIZE * SIZE, 0);
+	border.resize(SIZE, 0);
+}
+
+void BinaryMesher::Clear(uint32_t size) {
+	this->size = size;
+	std::fill(columns.begin(), columns.end(), 0);
+}
+
+void BinaryMesher::AddCube(int32_t x, int32_t y, int32_t z, int32_t width, uint16_t type) {
+	const int32_t lo[3] = { x, y, z };
+	const int32_t end = (int32_t)size;
+
+	for (uint8_t axis = 0; axis < 3; axis++) {
+		uint8_t u, v;
+		GreedyMesher::PlaneAxes(axis << 1, u, v);
+
+		// Along the column the cube may reach one cell past the box, across it only the box itself counts
+		int32_t first = std::max(lo[axis], -1) + 1;
+		int32_t last = std::min(lo[axis] + width, end + 1) + 1;
+		int32_t u0 = std::max(lo[u], 0), u1 = std::min(lo[u] + width, end);
+		int32_t v0 = std::max(lo[v], 0), v1 = std::min(lo[v] + width, end);
+		if (first >= last || u0 >= u1 || v0 >= v1) {
+			continue;
+		}
+
+		uint64_t bits = ((1ULL << last) - 1) & ~((1ULL << first) - 1);
+		for (int32_t i = u0; i < u1; i++) {
+			uint64_t* row = &columns[((size_t)axis * SIZE + i) * SIZE];
+			for (int32_t j = v0; j < v1; j++) {
+				row[j] |= bits;
+			}
+		}
+	}
+
+	int32_t x0 = std::max(x, 0), x1 = std::min(x + width, end);
+	int32_t y0 = std::max(y, 0), y1 = std::min(y + width, end);
+	int32_t z0 = std::max(z, 0), z1 = std::min(z + width, end);
+	for (int32_t i = x0; i < x1; i++) {
+		for (int32_t j = y0; j < y1; j++) {
+			uint16_t* row = &types[((size_t)i * SIZE + j) * SIZE];
+			std::fill(row + z0, row + z1, type);
+		}
+	}
+}
+
+void BinaryMesher::BeginBorder(uint8_t axis, uint32_t cells) {
+	borderAxis = axis;
+	borderCells = cells;
+	std::fill(border.begin(), border.end(), 0);
+}
+
+void BinaryMesher::AddBorderCube(int32_t x, int32_t y, int32_t z, int32_t width) {
+	const int32_t lo[3] = { x, y, z };
+	const int32_t end = (int32_t)(size * borderCells);
+	uint8_t u, v;
+	GreedyMesher::PlaneAxes(borderAxis << 1, u, v);
+
+	int32_t u0 = std::max(lo[u], 0), u1 = std::min(lo[u] + width, end);
+	int32_t v0 = std::max(lo[v], 0), v1 = std::min(lo[v] + width, end);
+	if (u0 >= u1 || v0 >= v1) {
+		return;
+	}
+	uint32_t bits = (uint32_t)(((1ULL << v1) - 1) & ~((1ULL << v0) - 1));
+	for (int32_t i = u0; i < u1; i++) {
+		border[i] |= bits;
+	}
+}
+
+void BinaryMesher::EndBorder(int32_t layer) {
+	uint8_t u, v;
+	GreedyMesher::PlaneAxes(borderAxis << 1, u, v);
+	const uint32_t cellBits = (uint32_t)((1ULL << borderCells) - 1);
+
+	for (uint32_t i = 0; i < size; i++) {
+		// The rows of the neighbor that this row of cells spans, and-ed: where all of them are covered
+		uint32_t covered = ~0U;
+		for (uint32_t row = i * borderCells; row < (i + 1) * borderCells; row++) {
+			covered &= border[row];
+		}
+		for (uint32_t j = 0; j < size; j++) {
+			if (((covered >> (j * borderCells)) & cellBits) == cellBits) {
+				int32_t pos[3];
+				pos[borderAxis] = layer;
+				pos[u] = (int32_t)i;
+				pos[v] = (int32_t)j;
+				AddCube(pos[0], pos[1], pos[2], 1, 0);
+			}
+		}
+	}
+}
+
+uint32_t BinaryMesher::FaceMask(uint8_t face, uint32_t u, uint32_t v) {
+	uint64_t column = columns[((size_t)(face >> 1) * SIZE + u) * SIZE + v];
+	uint64_t faces = (face & 1) ? column & ~(column >> 1) : column & ~(column << 1);
+	// Drop the cells outside of the box, their faces belong to the neighbors
+	return (uint32_t)((faces >> 1) & ((1ULL << size) - 1));
+}
+
+template <typename F>
+void BinaryMesher::ForEachFace(F& f) {
+	for (uint8_t face = 0; face < 6; face++) {
+		uint8_t axis = face >> 1;
+		uint8_t u, v;
+		GreedyMesher::PlaneAxes(face, u, v);
+		uint32_t pos[3];
+		for (pos[u] = 0; pos[u] < size; pos[u]++) {
+			for (pos[v] = 0; pos[v] < size; pos[v]++) {
+				for (uint32_t mask = FaceMask(face, pos[u], pos[v]); mask != 0; mask &= mask - 1) {
+					pos[axis] = Morton::LowestBit(mask);
+					f(face, pos[0], pos[1], pos[2], types[((size_t)pos[0] * SIZE + pos[1]) * SIZE + pos[2]]);
+				}
+			}
+		}
+	}
+}
+
+void BinaryMesher::CreateMesh(Renderer* renderer, glm::u32vec3 offset) {
+	renderer->ReserveFaces(FaceCount());
+	auto createFace = [&](uint8_t face, uint32_t x, uint32_t y, uint32_t z, uint16_t type) {
+		renderer->CreateFace(face, offset.x + x, offset.y + y, offset.z + z, 1, 1, 1, type);
+	};
+	ForEachFace(createFace);
+}
+
+void BinaryMesher::AddFaces(GreedyMesher& greedy, glm::u32vec3 offset) {
+	auto addFace = [&](uint8_t face, uint32_t x, uint32_t y, uint32_t z, uint16_t type) {
+		greedy.AddFace(face, offset.x + x, offset.y + y, offset.z + z, type);
+	};
+	ForEachFace(addFace);
+}
+
+size_t BinaryMesher::FaceCount() {
+	size_t faces = 0;
+	for (uint8_t face = 0; face < 6; face++) {
+		for (uint32_t u = 0; u < size; u++) {
+			for (uint32_t v = 0; v < size; v++) {
+				faces += Morton::PopCount(FaceMask(face, u, v));
+			}
+		}
+	}
+	return faces;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+/* Face culling on dense bitmasks, as an alternative to the visibility bitmasks of the octree
+*
+* A mesh box of up to 32^3 units is stored as occupancy columns, one 64-bit word per row of cells along each axis.
+* Bit i + 1 of a column is cell i, bits 0 and size + 1 are the cells just outside the box, so faces on the border
+* are culled against the neighbors as well. A cell has a face on the + side where the next cell is empty:
+* column & ~(column >> 1), and on the - side where the previous one is: column & ~(column << 1). That is a whole row
+* of faces in a few instructions, with no neighbor lookups.
+*
+* Only occupancy matters here, so a face between two cells is culled whatever their sizes in the tree were. The faces
+* are then either added as they are, or handed to a GreedyMesher to be merged.
+*
+* A neighbor meshed at a finer detail than the box only hides a face of the box where its smaller cubes cover all of
+* it. Its cubes are collected on a border grid at its own resolution first (BeginBorder, AddBorderCube), then EndBorder
+* fills the cells next to the box that are covered completely.
+*/
+
+#include "../Core/Renderer.h"
+#include "GreedyMesher.h"
+#include "glm/glm.hpp"
+#include <cstdint>
+#include <vector>
+
+class BinaryMesher {
+public:
+	static const uint32_t SIZE = 1U << Renderer::MESHDEPTH;	// Mesh units per axis, at most
+
+	BinaryMesher();
+
+	/* Empty the box, and set how many units it spans per axis (a power of two, up to SIZE) */
+	void Clear(uint32_t size);
+
+	/* Fill a cube, position and width in mesh units relative to the box. Parts outside of the box are clipped, except
+	for the layer of cells right next to it, which only culls the faces on the border */
+	void AddCube(int32_t x, int32_t y, int32_t z, int32_t width, uint16_t type);
+
+	/* Start collecting the cubes of a finer neighbor against the box, across the given axis (0 to 2 for x, y, z). The
+	neighbor has cells units per unit of the box, and the box times cells must fit in SIZE */
+	void BeginBorder(uint8_t axis, uint32_t cells);
+
+	/* A cube of the neighbor, in its units relative to the box. The coordinate along the axis is not looked at */
+	void AddBorderCube(int32_t x, int32_t y, int32_t z, int32_t width);
+
+	/* Fill the cells in the layer just outside of the box (-1 or the box size) whose face is covered completely */
+	void EndBorder(int32_t layer);
+
+	/* Add every visible face as its own quad. The offset is where the box is in the mesh, in mesh units */
+	void CreateMesh(Renderer* renderer, glm::u32vec3 offset);
+
+	/* Hand every visible face to the greedy mesher, which merges them on its CreateMesh() */
+	void AddFaces(GreedyMesher& greedy, glm::u32vec3 offset);
+
+	/* Number of visible faces */
+	size_t FaceCount();
+
+private:
+	uint32_t size = SIZE;
+	std::vector<uint64_t> columns;	// [axis][u][v], with u, v as in GreedyMesher::PlaneAxes()
+	std::vector<uint16_t> types;	// [x][y][z], the block type of the cells in the box. Only valid where filled
+	std::vector<uint32_t> border;	// [u][v] bit, a finer neighbor's cubes against the box, see BeginBorder()
+	uint8_t borderAxis = 0;
+	uint32_t borderCells = 1;
+
+	/* The visible faces of one column, bit i being cell i. Faces are numbered as in Renderer::PackVertex() */
+	uint32_t FaceMask(uint8_t face, uint32_t u, uint32_t v);
+
+	/* Calls f(face, x, y, z, type) for every visible face, positions relative to the box */
+	template <typename F>
+	void ForEachFace(F& f);
+};
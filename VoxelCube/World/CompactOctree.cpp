@@ -0,0 +1,222 @@
+#include "CompactOctree.h"
+
+CompactOctree::CompactOctree() {
+	AllocateBlock(1);	// The root, at index 0
+}
+
+CompactNode* CompactOctree::GetNode(uint32_t LocCode) {
+	uint32_t index = GetNodeIndex(LocCode);
+	if (index == CompactOctree::NONE) {
+		return nullptr;
+	}
+	return &nodes[index];
+}
+
+uint32_t CompactOctree::GetNodeIndex(uint32_t LocCode) {
+	if (LocCode == 0) {
+		return CompactOctree::NONE;
+	}
+
+	uint32_t depth = Octree::GetLocDepth(LocCode);
+	unsigned short shift = depth * 3 - 3;
+	uint32_t currentNode = 0;
+	// Same descent as Octree::GetNode, but each step only reads the 8 byte node
+	for (uint32_t i = 0; i < depth; i++) {
+		currentNode = GetChild(currentNode, (LocCode >> shift) & 7);
+		if (currentNode == CompactOctree::NONE) {
+			return CompactOctree::NONE;
+		}
+		shift -= 3;
+	}
+	return currentNode;
+}
+
+uint32_t CompactOctree::GetChild(uint32_t node, uint8_t i) {
+	uint8_t mask = nodes[node].ChildMask;
+	if (!((mask >> i) & 1U)) {
+		return CompactOctree::NONE;
+	}
+	return nodes[node].FirstChild + PopCount(mask & ((1U << i) - 1));
+}
+
+uint32_t CompactOctree::AddChild(uint32_t node, uint8_t i) {
+	uint8_t mask = nodes[node].ChildMask;
+	uint8_t count = PopCount(mask);
+	uint8_t rank = PopCount(mask & ((1U << i) - 1));	// Position of the new child in the block
+	uint32_t oldBlock = nodes[node].FirstChild;
+	uint32_t newBlock = AllocateBlock(count + 1);	// NOTE: May grow the arrays, so only hold on to indices
+
+	// Move the existing children over. Their own FirstChild indices stay valid, so grandchildren don't move
+	for (uint8_t j = 0; j < count; j++) {
+		uint32_t to = newBlock + j + (j >= rank);
+		nodes[to] = nodes[oldBlock + j];
+		colors[to] = colors[oldBlock + j];
+		leafFlags[to] = leafFlags[oldBlock + j];
+	}
+	nodes[newBlock + rank] = CompactNode();
+	colors[newBlock + rank] = glm::vec4(0.0f);
+	leafFlags[newBlock + rank] = false;
+
+	if (count > 0) {
+		freeBlocks[count].push_back(oldBlock);
+		freeSlots += count;
+	}
+
+	nodes[node].FirstChild = newBlock;
+	nodes[node].ChildMask = mask | (1U << i);
+	return newBlock + rank;
+}
+
+uint32_t CompactOctree::AllocateBlock(uint8_t size) {
+	if (!freeBlocks[size].empty()) {
+		uint32_t block = freeBlocks[size].back();
+		freeBlocks[size].pop_back();
+		freeSlots -= size;
+		return block;
+	}
+
+	uint32_t block = (uint32_t)nodes.size();
+	nodes.resize(nodes.size() + size);
+	colors.resize(colors.size() + size);
+	leafFlags.resize(leafFlags.size() + size);
+	return block;
+}
+
+void CompactOctree::InsertNode(uint32_t LocCode, glm::vec4 color, uint16_t id) {
+	uint32_t depth = Octree::GetLocDepth(LocCode);
+	unsigned short shift = 3 * depth - 3;
+	uint32_t currentNode = 0;
+	uint32_t currentLocCode = 1;
+	// Work our way down, creating children where needed
+	for (uint32_t i = 0; i < depth; i++) {
+		uint8_t child = (LocCode >> shift) & 7;
+		uint32_t nextNode = GetChild(currentNode, child);
+		if (nextNode == CompactOctree::NONE) {
+			nextNode = AddChild(currentNode, child);
+		}
+		currentNode = nextNode;
+		currentLocCode = (currentLocCode << 3) + child;
+
+		// Cull the faces shared with the neighbors, like Octree::InsertNode does
+		UpdateVisibility(currentLocCode);
+
+		shift -= 3;
+	}
+
+	colors[currentNode] = color;
+	leafFlags[currentNode] = true;
+	nodes[currentNode].id = id;
+}
+
+void CompactOctree::UpdateVisibility(uint32_t LocCode) {
+	uint32_t node = GetNodeIndex(LocCode);
+	if (node == CompactOctree::NONE) return;
+
+	// Same-sized neighbors only. Faces are numbered like the visibility bits, the opposite face is face ^ 1
+	for (uint8_t face = 0; face < 6; face++) {
+		uint32_t neighbor = GetNodeIndex(Octree::NeighborLocCode(LocCode, face));
+		if (neighbor != CompactOctree::NONE) {
+			Octree::UpdateVisibilityCode(nodes[node].visibility, face, 0);
+			Octree::UpdateVisibilityCode(nodes[neighbor].visibility, face ^ 1, 0);
+		}
+	}
+}
+
+void CompactOctree::CreateMesh(Renderer * renderer, uint32_t LocCode, size_t detail) {
+	// Same mesh box as Octree::CreateMesh
+	size_t depth = Octree::GetLocDepth(LocCode);
+	detail = std::min({ detail, (size_t)Renderer::MESHDEPTH, Octree::MAXDEPTH - depth });
+	if (renderer->vertexArray.empty()) {
+		renderer->SetMeshOrigin(Octree::LocCodeToPos(LocCode), 1U << (Octree::MAXDEPTH - depth - detail));
+	}
+	AddMesh(renderer, LocCode, detail);
+}
+
+void CompactOctree::AddMesh(Renderer * renderer, uint32_t LocCode, size_t detail) {
+	uint32_t node = GetNodeIndex(LocCode);
+	if (node == CompactOctree::NONE) return;
+
+	size_t depth = Octree::GetLocDepth(LocCode);
+	if (depth == Octree::MAXDEPTH || detail == 0) {
+		CreateMesh(renderer, LocCode);
+		return;
+	}
+
+	// If this is a leaf, we create the block
+	uint8_t mask = nodes[node].ChildMask;
+	if (mask == 0) {
+		CreateMesh(renderer, LocCode);
+		return;
+	}
+
+	// Else render the available children at a higher LOD
+	for (uint8_t i = 0; i < 8; i++) {
+		if (!((mask >> i) & 1U)) { continue; }
+		AddMesh(renderer, (LocCode << 3) + i, detail - 1);
+	}
+}
+
+void CompactOctree::CreateMesh(Renderer * renderer, uint32_t LocCode) {
+	uint32_t size = 1U << (Octree::MAXDEPTH - Octree::GetLocDepth(LocCode));	// Size of the cube
+
+	glm::vec3 pos = Octree::LocCodeToPos(LocCode);
+
+	uint32_t node = GetNodeIndex(LocCode);
+	if (node == CompactOctree::NONE) return;
+
+	renderer->CreateCube(pos.x, pos.y, pos.z, size, nodes[node].visibility, BlockType(node));
+}
+
+uint16_t CompactOctree::BlockType(uint32_t node) {
+	return (leafFlags[node] && nodes[node].ChildMask == 0) ? nodes[node].id : 0;
+}
+
+void CompactOctree::StageMesh(Renderer * renderer) {
+	renderer->UploadMesh();
+}
+
+void CompactOctree::Render(Renderer * renderer, Camera camera, const unsigned int WIDTH, const unsigned int HEIGHT) {
+	renderer->RenderMesh(&BlockShader::blocks(), camera, WIDTH, HEIGHT);
+}
+
+void CompactOctree::InsertRandomNodes(Renderer* renderer, size_t depth) {
+	InsertRandomNodes(renderer, (uint32_t)(1), depth);
+}
+
+void CompactOctree::InsertRandomNodes(Renderer* renderer, uint32_t LocCode, size_t depth) {
+	if (Octree::GetLocDepth(LocCode) == depth) {
+		return;
+	}
+
+	// Same shape as Octree::InsertRandomNodes
+	for (uint8_t i = 0; i < 5; i++) {
+		if (GetChild(GetNodeIndex(LocCode), i) == CompactOctree::NONE) {
+			InsertNode((LocCode << 3) + i, glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
+		}
+	}
+
+	uint8_t mask = nodes[GetNodeIndex(LocCode)].ChildMask;
+	for (uint8_t i = 0; i < 8; i++) {
+		if ((mask >> i) & 1U) {
+			InsertRandomNodes(renderer, (LocCode << 3) + i, depth);
+		}
+	}
+}
+
+size_t CompactOctree::NodeCount() {
+	return nodes.size() - freeSlots;
+}
+
+size_t CompactOctree::MemoryUsage() {
+	size_t bytes = nodes.capacity() * sizeof(CompactNode) + colors.capacity() * sizeof(glm::vec4) + leafFlags.capacity() * sizeof(uint8_t);
+	for (int i = 0; i < 9; i++) {
+		bytes += freeBlocks[i].capacity() * sizeof(uint32_t);
+	}
+	return bytes;
+}
+
+uint8_t CompactOctree::PopCount(uint8_t mask) {
+	mask = mask - ((mask >> 1) & 0x55);
+	mask = (mask & 0x33) + ((mask >> 2) & 0x33);
+	return (mask + (mask >> 4)) & 0x0F;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+/* Pointerless alternative to Octree, with the interface Octree had before it grew the features listed below
+*
+* A node is 8 bytes: a child-presence bitmask, the id, the visibility bitmask and a single 32-bit index to its children.
+* Children are packed: only the children that exist are stored, contiguously and in child index order, so the child with
+* index i lives at FirstChild + popcount(ChildMask & ((1 << i) - 1)).
+* Cold data (color, leaf flag) is kept in arrays parallel to the node array, indexed the same way.
+* Node 0 is the root. Location codes are never stored, they are implied by the path from the root.
+*
+* Inserting a child moves the whole sibling block to a block one larger. Freed blocks are recycled by size.
+* There is no DAG, and interior nodes keep no summaries: a node cut off by the level of detail is meshed with type 0.
+* NOTE: Only the naive meshing and the calls below are here. There is no RemoveNode, InsertBatch, index, DAG, chunk
+* tracking or culling, so it can't back a ChunkManager, and callers of those need the Octree
+* Source.cpp can run the game on it instead of Octree, as a single mesh of the whole world, see USE_COMPACT_OCTREE.
+*/
+
+#include "Octree.h"
+#include <vector>
+
+struct CompactNode {
+	uint32_t FirstChild = 0;	// Index of the first child. Only meaningful if ChildMask is non-zero
+	uint16_t id = 0;			// Same meaning as OctreeNode::id
+	uint8_t ChildMask = 0;		// Bit i set if child i exists
+	uint8_t visibility = (uint8_t)(255);	// Same layout as OctreeNode::visibility
+};
+
+static_assert(sizeof(CompactNode) == 8, "CompactNode should stay 8 bytes");
+
+class CompactOctree {
+static const uint32_t NONE = 0xFFFFFFFF;	// Index of a node that does not exist
+
+public:
+	CompactOctree();
+
+	/* Gets a node. If the node does not exist, returns a nullptr
+	NOTE: The pointer is invalidated by the next InsertNode */
+	CompactNode* GetNode(uint32_t LocCode);
+
+	/* Insert a node into the octree. NOTE: Currently overwrites existing nodes
+	The id is the block code of the node. Unlike Octree, the ids of the ancestors are not updated */
+	void InsertNode(uint32_t LocCode, glm::vec4 color, uint16_t id = 1);
+
+	/* Adds a mesh at a given level of detail. Same as Octree::CreateMesh in MeshingMode_Naive. Adds nothing if there is
+	no node at the LocCode */
+	void CreateMesh(Renderer * renderer, uint32_t LocCode, size_t detail);
+
+	/* Add a block to the renderer, without considering child nodes */
+	void CreateMesh(Renderer * renderer, uint32_t LocCode);
+
+	/* Stage the mesh... NOTE: this appends(!) to the mesh vector*/
+	void StageMesh(Renderer* renderer);
+
+	/* Here for testing purposes. Creates random tree at the given height */
+	void InsertRandomNodes(Renderer* renderer, size_t depth);
+
+	/* Render the blocks that were staged by createMesh() */
+	void Render(Renderer* renderer, Camera camera, const unsigned int WIDTH, const unsigned int HEIGHT);
+
+	/* Updates the visibility of a node at the LocCode */
+	void UpdateVisibility(uint32_t LocCode);
+
+	/* Number of nodes in the tree, the root included */
+	size_t NodeCount();
+
+	/* Bytes held by the node and side arrays */
+	size_t MemoryUsage();
+
+private:
+	std::vector<CompactNode> nodes;
+	std::vector<glm::vec4> colors;		// Parallel to nodes
+	std::vector<uint8_t> leafFlags;		// Parallel to nodes. Same meaning as OctreeNode::isLeaf
+
+	std::vector<uint32_t> freeBlocks[9];	// Unused child blocks, indexed by their size
+	size_t freeSlots = 0;					// Total slots in freeBlocks
+
+	/* Same as GetNode, but returns an index. NONE if the node does not exist */
+	uint32_t GetNodeIndex(uint32_t LocCode);
+
+	/* Index of child i of the node, NONE if there is no such child */
+	uint32_t GetChild(uint32_t node, uint8_t i);
+
+	/* Adds child i to the node, moving its sibling block. Returns the index of the new child */
+	uint32_t AddChild(uint32_t node, uint8_t i);
+
+	/* Get a block of consecutive free slots, reusing a freed block if possible */
+	uint32_t AllocateBlock(uint8_t size);
+
+	void InsertRandomNodes(Renderer* renderer, uint32_t LocCode, size_t depth);
+
+	/* CreateMesh() without setting up the mesh origin */
+	void AddMesh(Renderer * renderer, uint32_t LocCode, size_t detail);
+
+	/* Block type to mesh the node with, like Octree. 0 for nodes that are not a block */
+	uint16_t BlockType(uint32_t node);
+
+	/* Number of set bits in a child mask */
+	static uint8_t PopCount(uint8_t mask);
+};
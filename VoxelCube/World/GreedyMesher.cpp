@@ -0,0 +1,112 @@
+#include "GreedyMesher.h"
+
+GreedyMesher::GreedyMesher() {
+	cells.resize(6 * SIZE * SIZE * SIZE, 0);
+}
+
+void GreedyMesher::AddCube(uint32_t x, uint32_t y, uint32_t z, uint32_t width, uint8_t visibility, uint16_t type) {
+	const uint32_t pos[3] = { x, y, z };
+	for (uint8_t face = 0; face < 6; face++) {
+		if (!((visibility >> (5 - face)) & 1U)) {
+			continue;
+		}
+		uint8_t axis = face >> 1;
+		uint8_t u, v;
+		PlaneAxes(face, u, v);
+
+		// Negative faces lie in the first layer of the cube, positive faces in the last
+		uint32_t layer = pos[axis] + ((face & 1) ? width - 1 : 0);
+		uint16_t* slice = &cells[((size_t)face * SIZE + layer) * SIZE * SIZE];
+		for (uint32_t j = pos[v]; j < pos[v] + width; j++) {
+			for (uint32_t i = pos[u]; i < pos[u] + width; i++) {
+				slice[j * SIZE + i] = type + 1;
+			}
+		}
+		usedLayers[face] |= 1U << layer;
+	}
+}
+
+void GreedyMesher::AddFace(uint8_t face, uint32_t x, uint32_t y, uint32_t z, uint16_t type) {
+	const uint32_t pos[3] = { x, y, z };
+	uint8_t u, v;
+	PlaneAxes(face, u, v);
+	uint32_t layer = pos[face >> 1];
+	cells[(((size_t)face * SIZE + layer) * SIZE + pos[v]) * SIZE + pos[u]] = type + 1;
+	usedLayers[face] |= 1U << layer;
+}
+
+void GreedyMesher::CreateMesh(Renderer* renderer) {
+	quads.clear();
+	for (uint8_t face = 0; face < 6; face++) {
+		for (uint32_t layer = 0; layer < SIZE; layer++) {
+			if ((usedLayers[face] >> layer) & 1U) {
+				MergeLayer(face, layer);
+			}
+		}
+		usedLayers[face] = 0;
+	}
+
+	renderer->ReserveFaces(quads.size());
+	for (Quad& quad : quads) {
+		renderer->CreateFace(quad.face, quad.pos[0], quad.pos[1], quad.pos[2], quad.size[0], quad.size[1], quad.size[2], quad.type);
+	}
+}
+
+void GreedyMesher::MergeLayer(uint8_t face, uint32_t layer) {
+	uint16_t* slice = &cells[((size_t)face * SIZE + layer) * SIZE * SIZE];
+	uint8_t u, v;
+	PlaneAxes(face, u, v);
+
+	for (uint32_t j = 0; j < SIZE; j++) {
+		for (uint32_t i = 0; i < SIZE; i++) {
+			uint16_t type = slice[j * SIZE + i];
+			if (type == 0) {
+				continue;
+			}
+
+			// Widest run along u, then as many rows along v as match all of it
+			uint32_t width = 1;
+			while (i + width < SIZE && slice[j * SIZE + i + width] == type) {
+				width++;
+			}
+			uint32_t height = 1;
+			for (; j + height < SIZE; height++) {
+				uint16_t* row = &slice[(j + height) * SIZE + i];
+				uint32_t k = 0;
+				while (k < width && row[k] == type) {
+					k++;
+				}
+				if (k < width) {
+					break;
+				}
+			}
+
+			for (uint32_t b = j; b < j + height; b++) {
+				for (uint32_t a = i; a < i + width; a++) {
+					slice[b * SIZE + a] = 0;
+				}
+			}
+
+			Quad quad;
+			quad.face = face;
+			quad.type = type - 1;
+			quad.pos[face >> 1] = layer;
+			quad.pos[u] = i;
+			quad.pos[v] = j;
+			quad.size[face >> 1] = 1;
+			quad.size[u] = width;
+			quad.size[v] = height;
+			quads.push_back(quad);
+
+			i += width - 1;
+		}
+	}
+}
+
+void GreedyMesher::PlaneAxes(uint8_t face, uint8_t& u, uint8_t& v) {
+	switch (face >> 1) {
+	case 0: u = 1; v = 2; break;
+	case 1: u = 0; v = 2; break;
+	default: u = 0; v = 1; break;
+	}
+}
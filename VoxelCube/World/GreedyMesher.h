@@ -0,0 +1,49 @@
+#pragma once
+
+/* Greedy meshing of one mesh box (a chunk of 32^3 mesh units, see Renderer::MESHDEPTH)
+*
+* The visible faces are first written into one 32x32 grid per face direction and per slice along its axis, holding
+* the block type of the face in every cell. Each slice is then covered with maximal rectangles of the same type:
+* grow along u while the type matches, then along v while the whole row matches. Every rectangle becomes one quad.
+*
+* Which faces are visible is taken as given (from the visibility bitmasks), so the result covers exactly the same
+* surface as the naive mesh, just with fewer quads. The grids are kept between meshes, merging leaves them empty again.
+*/
+
+#include "../Core/Renderer.h"
+#include <cstdint>
+#include <vector>
+
+class GreedyMesher {
+public:
+	static const uint32_t SIZE = 1U << Renderer::MESHDEPTH;	// Mesh units per axis
+
+	GreedyMesher();
+
+	/* Mark the visible faces of a cube. Position and width in mesh units, visibility as in Octree.h */
+	void AddCube(uint32_t x, uint32_t y, uint32_t z, uint32_t width, uint8_t visibility, uint16_t type);
+
+	/* Mark a single visible face (0 to 5, as in Renderer::PackVertex()) of the unit cube at x, y, z */
+	void AddFace(uint8_t face, uint32_t x, uint32_t y, uint32_t z, uint16_t type);
+
+	/* Merge the marked faces into rectangles and add them to the renderer. Clears the marked faces */
+	void CreateMesh(Renderer* renderer);
+
+	/* The two axes in the plane of a face, in x, y, z order */
+	static void PlaneAxes(uint8_t face, uint8_t& u, uint8_t& v);
+
+private:
+	struct Quad {
+		uint8_t face;
+		uint32_t pos[3];
+		uint32_t size[3];
+		uint16_t type;
+	};
+
+	std::vector<uint16_t> cells;	// [face][layer][v][u], the block type + 1, or 0 where there is no face
+	uint32_t usedLayers[6] = { 0 };	// Per face, bit i is set if layer i may have faces
+	std::vector<Quad> quads;		// Output of the last merge, kept to avoid allocating
+
+	/* Merge one slice into quads */
+	void MergeLayer(uint8_t face, uint32_t layer);
+};
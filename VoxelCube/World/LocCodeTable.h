@@ -0,0 +1,136 @@
+#pragma once
+
+/* Open-addressing hash table from location codes to nodes, as in a linear hashed octree
+*
+* Entries live in one flat array with linear probing, so a lookup is usually a single cache line. A code of 0 is never
+* valid, hence it marks an empty slot. Erasing shifts the following entries of the cluster back rather than leaving
+* tombstones, so lookups don't get slower as nodes come and go.
+* The table doubles once it is half full. Codes are mixed with a Fibonacci hash, as consecutive codes (siblings) only
+* differ in their low bits.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+template <typename LocCode_t, typename T>
+class LocCodeTable {
+public:
+	LocCodeTable() { };
+
+	/* The node at the location code, or a nullptr */
+	T* Find(LocCode_t LocCode) const {
+		if (entries.empty()) {
+			return nullptr;
+		}
+		for (size_t i = Slot(LocCode);; i = (i + 1) & mask) {
+			if (entries[i].LocCode == LocCode) {
+				return entries[i].node;
+			}
+			if (entries[i].LocCode == 0) {
+				return nullptr;
+			}
+		}
+	}
+
+	/* Add the node at the location code, replacing the node that was there */
+	void Insert(LocCode_t LocCode, T* node) {
+		if (2 * (size + 1) > entries.size()) {
+			Rehash(entries.empty() ? 64 : 2 * entries.size());
+		}
+		size_t i = Slot(LocCode);
+		while (entries[i].LocCode != 0 && entries[i].LocCode != LocCode) {
+			i = (i + 1) & mask;
+		}
+		if (entries[i].LocCode == 0) {
+			size++;
+		}
+		entries[i] = { LocCode, node };
+	}
+
+	/* Remove the location code, if it is in the table */
+	void Erase(LocCode_t LocCode) {
+		if (entries.empty()) {
+			return;
+		}
+		size_t i = Slot(LocCode);
+		while (entries[i].LocCode != LocCode) {
+			if (entries[i].LocCode == 0) {
+				return;
+			}
+			i = (i + 1) & mask;
+		}
+
+		// Move later entries of the cluster into the gap, unless that would put them before their home slot
+		size_t gap = i;
+		for (size_t j = (i + 1) & mask; entries[j].LocCode != 0; j = (j + 1) & mask) {
+			size_t home = Slot(entries[j].LocCode);
+			if (((j - home) & mask) >= ((j - gap) & mask)) {
+				entries[gap] = entries[j];
+				gap = j;
+			}
+		}
+		entries[gap] = Entry();
+		size--;
+	}
+
+	/* Make room for at least n entries without growing */
+	void Reserve(size_t n) {
+		size_t capacity = 64;
+		while (capacity < 2 * n) {
+			capacity *= 2;
+		}
+		if (capacity > entries.size()) {
+			Rehash(capacity);
+		}
+	}
+
+	void Clear() {
+		entries.clear();
+		entries.shrink_to_fit();
+		size = 0;
+		mask = 0;
+	}
+
+	/* Number of entries */
+	size_t Size() const { return size; }
+
+	/* Bytes held by the table */
+	size_t Capacity() const { return entries.capacity() * sizeof(Entry); }
+
+private:
+	struct Entry {
+		LocCode_t LocCode = 0;
+		T* node = nullptr;
+	};
+
+	std::vector<Entry> entries;	// Size is a power of two
+	size_t size = 0;
+	size_t mask = 0;			// entries.size() - 1
+	unsigned int bits = 0;		// log2(entries.size())
+
+	size_t Slot(LocCode_t LocCode) const {
+		return (size_t)(((uint64_t)LocCode * 0x9E3779B97F4A7C15ULL) >> (64 - bits));
+	}
+
+	void Rehash(size_t capacity) {
+		std::vector<Entry> old;
+		old.swap(entries);
+		entries.resize(capacity);
+		mask = capacity - 1;
+		bits = 0;
+		while (((size_t)1 << bits) < capacity) {
+			bits++;
+		}
+		for (Entry& entry : old) {
+			if (entry.LocCode == 0) {
+				continue;
+			}
+			size_t i = Slot(entry.LocCode);
+			while (entries[i].LocCode != 0) {
+				i = (i + 1) & mask;
+			}
+			entries[i] = entry;
+		}
+	}
+};
@@ -0,0 +1,182 @@
+#pragma once
+
+/* Morton (Z-order) encoding, as used by the location codes
+*
+* Bit 3i + 2 of a code holds bit i of x, bit 3i + 1 holds bit i of y and bit 3i holds bit i of z.
+* There is a version per location code width: 32-bit codes hold 10 bits per coordinate, 64-bit codes hold 21.
+* The implementation is picked at compile time: pdep/pext when the target has BMI2, otherwise the usual
+* shift-and-mask "magic number" spreading, which is branchless and needs no lookup tables.
+* NOTE: AMD CPUs before Zen 3 have BMI2, but with a very slow pdep/pext. Build without BMI2 for those
+*/
+
+#include <cstdint>
+
+#if defined(__BMI2__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define MORTON_USE_BMI2 1
+#include <immintrin.h>
+#else
+#define MORTON_USE_BMI2 0
+#endif
+
+// The 64-bit pdep/pext only exist on x64
+#if MORTON_USE_BMI2 && (defined(__x86_64__) || defined(_M_X64))
+#define MORTON_USE_BMI2_64 1
+#else
+#define MORTON_USE_BMI2_64 0
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Morton {
+	const uint32_t MASK_X = 0x24924924;	// Bits 2, 5, 8, ...
+	const uint32_t MASK_Y = 0x12492492;	// Bits 1, 4, 7, ...
+	const uint32_t MASK_Z = 0x09249249;	// Bits 0, 3, 6, ...
+
+	const uint64_t MASK_X64 = 0x4924924924924924;	// Bits 2, 5, 8, ..., 62
+	const uint64_t MASK_Y64 = 0x2492492492492492;	// Bits 1, 4, 7, ..., 61
+	const uint64_t MASK_Z64 = 0x1249249249249249;	// Bits 0, 3, 6, ..., 60
+
+	/* Spread the low 10 bits of v so there are two zero bits between each of them */
+	inline uint32_t Spread(uint32_t v) {
+		v &= 0x000003FF;
+		v = (v | (v << 16)) & 0x030000FF;
+		v = (v | (v << 8)) & 0x0300F00F;
+		v = (v | (v << 4)) & 0x030C30C3;
+		v = (v | (v << 2)) & 0x09249249;
+		return v;
+	}
+
+	/* Inverse of Spread: gather every third bit, starting at bit 0 */
+	inline uint32_t Compact(uint32_t v) {
+		v &= 0x09249249;
+		v = (v ^ (v >> 2)) & 0x030C30C3;
+		v = (v ^ (v >> 4)) & 0x0300F00F;
+		v = (v ^ (v >> 8)) & 0x030000FF;
+		v = (v ^ (v >> 16)) & 0x000003FF;
+		return v;
+	}
+
+	/* Spread the low 21 bits of v over a 64 bit integer, like Spread */
+	inline uint64_t Spread64(uint64_t v) {
+		v &= 0x00000000001FFFFF;
+		v = (v | (v << 32)) & 0x001F00000000FFFF;
+		v = (v | (v << 16)) & 0x001F0000FF0000FF;
+		v = (v | (v << 8)) & 0x100F00F00F00F00F;
+		v = (v | (v << 4)) & 0x10C30C30C30C30C3;
+		v = (v | (v << 2)) & 0x1249249249249249;
+		return v;
+	}
+
+	/* Inverse of Spread64 */
+	inline uint64_t Compact64(uint64_t v) {
+		v &= 0x1249249249249249;
+		v = (v ^ (v >> 2)) & 0x10C30C30C30C30C3;
+		v = (v ^ (v >> 4)) & 0x100F00F00F00F00F;
+		v = (v ^ (v >> 8)) & 0x001F0000FF0000FF;
+		v = (v ^ (v >> 16)) & 0x001F00000000FFFF;
+		v = (v ^ (v >> 32)) & 0x00000000001FFFFF;
+		return v;
+	}
+
+	/* Interleave three coordinates into a code of the given width. Only declared here, see the specializations */
+	template <typename T>
+	T Encode(uint32_t x, uint32_t y, uint32_t z);
+
+	/* Interleave three 10 bit coordinates into a 30 bit code */
+	template <>
+	inline uint32_t Encode<uint32_t>(uint32_t x, uint32_t y, uint32_t z) {
+#if MORTON_USE_BMI2
+		return _pdep_u32(x, MASK_X) | _pdep_u32(y, MASK_Y) | _pdep_u32(z, MASK_Z);
+#else
+		return (Spread(x) << 2) | (Spread(y) << 1) | Spread(z);
+#endif
+	}
+
+	/* Interleave three 21 bit coordinates into a 63 bit code */
+	template <>
+	inline uint64_t Encode<uint64_t>(uint32_t x, uint32_t y, uint32_t z) {
+#if MORTON_USE_BMI2_64
+		return _pdep_u64(x, MASK_X64) | _pdep_u64(y, MASK_Y64) | _pdep_u64(z, MASK_Z64);
+#else
+		return (Spread64(x) << 2) | (Spread64(y) << 1) | Spread64(z);
+#endif
+	}
+
+	/* Split a 30 bit code back into its three coordinates */
+	inline void Decode(uint32_t code, uint32_t& x, uint32_t& y, uint32_t& z) {
+#if MORTON_USE_BMI2
+		x = _pext_u32(code, MASK_X);
+		y = _pext_u32(code, MASK_Y);
+		z = _pext_u32(code, MASK_Z);
+#else
+		x = Compact(code >> 2);
+		y = Compact(code >> 1);
+		z = Compact(code);
+#endif
+	}
+
+	/* Split a 63 bit code back into its three coordinates */
+	inline void Decode(uint64_t code, uint32_t& x, uint32_t& y, uint32_t& z) {
+#if MORTON_USE_BMI2_64
+		x = (uint32_t)_pext_u64(code, MASK_X64);
+		y = (uint32_t)_pext_u64(code, MASK_Y64);
+		z = (uint32_t)_pext_u64(code, MASK_Z64);
+#else
+		x = (uint32_t)Compact64(code >> 2);
+		y = (uint32_t)Compact64(code >> 1);
+		z = (uint32_t)Compact64(code);
+#endif
+	}
+
+	/* Index of the most significant set bit. The code must not be 0 */
+	inline uint32_t HighestBit(uint32_t code) {
+#if defined(__GNUC__)
+		return 31 - __builtin_clz(code);
+#elif defined(_MSC_VER)
+		unsigned long msb;
+		_BitScanReverse(&msb, code);
+		return msb;
+#endif
+	}
+
+	inline uint32_t HighestBit(uint64_t code) {
+#if defined(__GNUC__)
+		return 63 - __builtin_clzll(code);
+#elif defined(_MSC_VER) && defined(_M_X64)
+		unsigned long msb;
+		_BitScanReverse64(&msb, code);
+		return msb;
+#elif defined(_MSC_VER)
+		unsigned long msb;
+		if (_BitScanReverse(&msb, (uint32_t)(code >> 32))) {
+			return msb + 32;
+		}
+		_BitScanReverse(&msb, (uint32_t)code);
+		return msb;
+#endif
+	}
+
+	/* Index of the least significant set bit. The code must not be 0 */
+	inline uint32_t LowestBit(uint32_t code) {
+#if defined(__GNUC__)
+		return __builtin_ctz(code);
+#elif defined(_MSC_VER)
+		unsigned long lsb;
+		_BitScanForward(&lsb, code);
+		return lsb;
+#endif
+	}
+
+	/* Number of set bits */
+	inline uint32_t PopCount(uint32_t code) {
+#if defined(__GNUC__)
+		return __builtin_popcount(code);
+#else
+		code = code - ((code >> 1) & 0x55555555);
+		code = (code & 0x33333333) + ((code >> 2) & 0x33333333);
+		return (((code + (code >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+#endif
+	}
+}
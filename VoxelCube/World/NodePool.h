@@ -0,0 +1,87 @@
+#pragma once
+
+/* Slab allocator for octree nodes
+*
+* Nodes are handed out from contiguous blocks of BLOCKSIZE nodes, so nodes created together (siblings, whole subtrees
+* built by InsertNode) end up next to each other in memory. Freed nodes are pushed onto an intrusive free list and are
+* reused before a new block is allocated.
+*
+* Clear() releases all blocks at once, so tearing down a tree costs O(blocks) rather than one delete per node.
+* NOTE: Destructors are never run, hence T must be trivially destructible
+*/
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template <typename T, size_t BLOCKSIZE = 4096>
+class NodePool {
+	static_assert(std::is_trivially_destructible<T>::value, "NodePool drops its blocks without calling destructors");
+
+public:
+	NodePool() { };
+	~NodePool() { Clear(); };
+
+	NodePool(const NodePool&) = delete;
+	NodePool& operator=(const NodePool&) = delete;
+
+	/* Construct a node in the pool. Reuses a freed slot if there is one */
+	template <typename... Args>
+	T* Allocate(Args&&... args) {
+		Slot* slot;
+		if (freeList != nullptr) {
+			slot = freeList;
+			freeList = freeList->next;
+		}
+		else {
+			if (used == BLOCKSIZE) {	// Newest block is full
+				blocks.push_back(new Slot[BLOCKSIZE]);
+				used = 0;
+			}
+			slot = &blocks.back()[used++];
+		}
+		liveNodes++;
+		return new (slot->storage) T(std::forward<Args>(args)...);
+	}
+
+	/* Return a node to the free list. The node must have been allocated by this pool */
+	void Free(T* node) {
+		if (node == nullptr) {
+			return;
+		}
+		Slot* slot = reinterpret_cast<Slot*>(node);
+		slot->next = freeList;
+		freeList = slot;
+		liveNodes--;
+	}
+
+	/* Release every block. All nodes handed out by the pool become invalid */
+	void Clear() {
+		for (Slot* block : blocks) {
+			delete[] block;
+		}
+		blocks.clear();
+		freeList = nullptr;
+		used = BLOCKSIZE;
+		liveNodes = 0;
+	}
+
+	/* Number of nodes currently handed out */
+	size_t Size() const { return liveNodes; }
+
+	/* Bytes reserved by the pool's blocks */
+	size_t Capacity() const { return blocks.size() * BLOCKSIZE * sizeof(Slot); }
+
+private:
+	union Slot {
+		Slot* next;
+		alignas(T) unsigned char storage[sizeof(T)];
+	};
+
+	std::vector<Slot*> blocks;
+	Slot* freeList = nullptr;
+	size_t used = BLOCKSIZE;	// Slots used in the newest block. Starts "full" so the first Allocate() creates a block
+	size_t liveNodes = 0;
+};
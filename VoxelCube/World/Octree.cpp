@@ -1,40 +1,59 @@
 #include "Octree.h"
+#include <functional>
 #include <random>
 
-Octree::Octree() {
-	root = new OctreeNode(nullptr, (uint32_t)(1));	// Zero initialize octree
+template <typename LocCode_t>
+BasicOctree<LocCode_t>::BasicOctree() {
+	root = nodePool.Allocate(nullptr, (LocCode_t)(1));	// Zero initialize octree
 	root->LocCode = 1;	// 0...0001. A depth of 0
 }
 
-Octree::~Octree() {
-	DeleteNode(root);	// Delete root
+template <typename LocCode_t>
+BasicOctree<LocCode_t>::~BasicOctree() {
+	nodePool.Clear();	// Drops all nodes at once, no need to traverse the tree
+	root = nullptr;
 	return;
 }
 
-void Octree::DeleteNode(uint32_t LocCode) {
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::DeleteNode(LocCode_t LocCode) {
 	OctreeNode* node = GetNode(LocCode);
 	DeleteNode(node);
 	return;
 }
 
-void Octree::DeleteNode(OctreeNode* node) {
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::DeleteNode(OctreeNode* node) {
 	if (node == nullptr) {
 		return;
 	}
 
+	// Still used elsewhere in the DAG
+	if (--node->refCount > 0) {
+		return;
+	}
+	Unhash(node);
+
 	for (int i = 0; i < 8; i++) {	// Post-order traversal
 		if (node->Children[i] != nullptr) {
 			DeleteNode(node->Children[i]);
 		}
 	}
-	delete node;
+	if (isIndexed) {	// Never the case in a DAG, so the LocCode is right
+		index.Erase(node->LocCode);
+	}
+	nodePool.Free(node);
 	node = nullptr;
 }
 
-OctreeNode* Octree::GetNode(uint32_t LocCode) {
+template <typename LocCode_t>
+BasicOctreeNode<LocCode_t>* BasicOctree<LocCode_t>::GetNode(LocCode_t LocCode) {
 	if (LocCode == NULL) {
 		return nullptr;
 	}
+	if (isIndexed) {
+		return index.Find(LocCode);
+	}
 
 	uint32_t depth = GetLocDepth(LocCode);
 	unsigned short shift = depth * 3 - 3;
@@ -51,184 +70,609 @@ OctreeNode* Octree::GetNode(uint32_t LocCode) {
 	return currentNode;
 }
 
-void Octree::InsertNode(uint32_t LocCode, glm::vec4 color) {
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::InsertNode(LocCode_t LocCode, glm::vec4 color, uint16_t id) {
 	uint32_t depth = GetLocDepth(LocCode);
 	unsigned short shift = 3 * depth - 3;
 	OctreeNode* currentNode = root;
 	// Work our way down. The bitwise shift just extracts the relevant index
-	for (int i = 0; i < depth; i++) {
+	for (uint32_t i = 0; i < depth; i++) {
+		bool created = false;
 		// Need to create the child if it doesn't exist
 		if (currentNode->Children[(LocCode >> shift & 7)] == nullptr) {
-			currentNode->Children[(LocCode >> shift & 7)] = new OctreeNode(currentNode, ((currentNode->LocCode) << 3) + ((LocCode >> shift) & 7));
-			// TODO: Update visibility of child here
+			if (currentNode != root && IsBlock(currentNode)) {
+				SplitBlock(currentNode->LocCode);
+				MarkDirty(LocCode >> (shift + 3));	// The rest of the block is gone
+			}
+			currentNode->Children[(LocCode >> shift & 7)] = CreateChild(currentNode, (LocCode >> shift) & 7);
+			created = true;
+		}
+		else if (isDAG) {	// Copy the child first if it is shared
+			MakeUnique(currentNode, (LocCode >> shift) & 7);
 		}
 		OctreeNode* nextNode = currentNode->Children[(LocCode >> shift & 7)];
 		
 		currentNode = nextNode;
 		// Now we also need to cull the face later, so change the bitmap of the node as well as the surrounding nodes
-		UpdateVisibility(currentNode->LocCode);
+		// Nodes that were already there have been culled when they, or their neighbors, were created. The node itself
+		// is done below, once it is a block
+		if (created && i + 1 < depth) {
+			CullFaces(currentNode);
+		}
 
 		shift -= 3;
 	}
 
 	currentNode->color = color;
 	currentNode->isLeaf = true;
-}
+	currentNode->id = id;
+	CullFaces(currentNode);
+	UpdateIds(currentNode);
+	MarkDirty(LocCode);
 
-void Octree::RemoveNode(uint32_t LocCode) {
-	return;
+	if (isDAG) {
+		editedLocCodes.push_back(LocCode);
+		Recompress();
+	}
 }
 
-uint32_t Octree::GetLocDepth(uint32_t LocCode) {
-#if defined(__GNUC__)
-    return (31 - __builtin_clz(node->LocCode)) / 3;
-#elif defined(_MSC_VER)
-	unsigned long msb;
-	_BitScanReverse(&msb, LocCode);
-	return msb / 3;
-#endif
-}
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::InsertBatch(std::vector<VoxelInsert>& voxels) {
+	if (isDAG) {	// Every edit has to go through copy-on-write
+		for (VoxelInsert& voxel : voxels) {
+			InsertNode(voxel.LocCode, voxel.color, voxel.id);
+		}
+		return;
+	}
 
-void Octree::UpdateVisibility(uint32_t LocCode) {
-	// TODO: might not need this node here. Could create an overriding updatevisibility(loccode) function instead
-	OctreeNode* node = GetNode(LocCode);
-	if (node == nullptr) return;
+	// Morton order: drop the leading 1 and align all codes to MAXDEPTH. Equal keys (a node and its first descendants)
+	// are ordered by depth, and stable_sort keeps duplicates in order so the last one still wins
+	auto MortonKey = [](LocCode_t LocCode) {
+		uint32_t depth = GetLocDepth(LocCode);
+		LocCode_t aligned = (LocCode ^ ((LocCode_t)1 << (3 * depth))) << (3 * (BasicOctree::MAXDEPTH - depth));
+		return std::make_pair(aligned, depth);
+	};
+	std::stable_sort(voxels.begin(), voxels.end(), [&](const VoxelInsert& a, const VoxelInsert& b) {
+		return MortonKey(a.LocCode) < MortonKey(b.LocCode);
+	});
 
-	size_t depth = GetLocDepth(LocCode);
-	glm::u32vec3 pos = LocCodeToPos(LocCode);
-	uint32_t size = pow(2, (Octree::MAXDEPTH - GetLocDepth(LocCode)));	// Size of the cube
+	OctreeNode* path[BasicOctree::MAXDEPTH + 1] = { root };	// Path to the previous voxel
+	uint32_t pathDepth = 0;
+	std::vector<OctreeNode*> touched = { root };	// Every node on a path, parents before children
+	std::vector<OctreeNode*> created;				// The new nodes
 
-	OctreeNode* neighbor;
+	for (VoxelInsert& voxel : voxels) {
+		uint32_t depth = GetLocDepth(voxel.LocCode);
 
-	// Front x neighbor
-	neighbor = GetNode(PosToLocCode(glm::u32vec3(pos.x + size, pos.y, pos.z), depth));
-	if (neighbor != nullptr) {
-		UpdateVisibilityCode(node->visibility, 4, 0);
-		UpdateVisibilityCode(neighbor->visibility, 5, 0);
+		// Keep the part of the previous path that this voxel shares
+		uint32_t common = std::min(depth, pathDepth);
+		while (common > 0 && (voxel.LocCode >> (3 * (depth - common))) != path[common]->LocCode) {
+			common--;
+		}
+
+		for (uint32_t level = common + 1; level <= depth; level++) {
+			OctreeNode* parent = path[level - 1];
+			uint8_t child = (voxel.LocCode >> (3 * (depth - level))) & 7;
+			if (parent->Children[child] == nullptr) {
+				if (parent != root && IsBlock(parent)) {
+					SplitBlock(parent->LocCode);
+					MarkDirty(parent->LocCode);
+				}
+				parent->Children[child] = CreateChild(parent, child);
+				created.push_back(parent->Children[child]);
+			}
+			path[level] = parent->Children[child];
+			touched.push_back(path[level]);
+		}
+		pathDepth = depth;
+
+		OctreeNode* node = path[depth];
+		node->color = voxel.color;
+		node->isLeaf = true;
+		node->id = voxel.id;
+		MarkDirty(voxel.LocCode);
 	}
-	
-	// Back x neighbor
-	neighbor = GetNode(PosToLocCode(glm::u32vec3(pos.x - size, pos.y, pos.z), depth));
-	if (neighbor != nullptr) {
-		UpdateVisibilityCode(node->visibility, 5, 0);
-		UpdateVisibilityCode(neighbor->visibility, 4, 0);
+
+	// Children come after their parents in touched, so going backwards sums the ids bottom-up
+	for (auto it = touched.rbegin(); it != touched.rend(); ++it) {
+		Summarize(*it);
 	}
 
-	// Front y neighbor
-	neighbor = GetNode(PosToLocCode(glm::u32vec3(pos.x, pos.y + size, pos.z), depth));
-	if (neighbor != nullptr) {
-		UpdateVisibilityCode(node->visibility, 2, 0);
-		UpdateVisibilityCode(neighbor->visibility, 3, 0);
+	// Culling is symmetric, so culling the new nodes also takes care of the nodes that were already there
+	for (OctreeNode* node : created) {
+		CullFaces(node);
 	}
-	
-	// Back y neighbor
-	neighbor = GetNode(PosToLocCode(glm::u32vec3(pos.x, pos.y - size, pos.z), depth));
-	if (neighbor != nullptr) {
-		UpdateVisibilityCode(node->visibility, 3, 0);
-		UpdateVisibilityCode(neighbor->visibility, 2, 0);
+}
+
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::UpdateIds(OctreeNode* node) {
+	while (node != nullptr) {
+		Summarize(node);
+		node = node->Parent;
 	}
+}
+
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::Summarize(OctreeNode* node) {
+	bool hasChildren = false;
+	bool solid = true;
+	uint16_t sum = 0;	// Wraps around, so this is the sum mod 65536
+	float fill = 0.0f;
+	glm::vec4 color(0.0f);
+	// The volume each type fills, by the children's types. There are at most 8 of them
+	uint16_t types[8];
+	float volumes[8];
+	int typeCount = 0;
+	for (int i = 0; i < 8; i++) {
+		OctreeNode* child = node->Children[i];
+		if (child == nullptr) {
+			solid = false;
+			continue;
+		}
+		hasChildren = true;
+		sum += child->id;
+		solid = solid && child->isSolid;
+		fill += child->fill;
+		color += child->fill * child->color;
 
-	// Front z neighbor
-	neighbor = GetNode(PosToLocCode(glm::u32vec3(pos.x, pos.y, pos.z + size), depth));
-	if (neighbor != nullptr) {
-		UpdateVisibilityCode(node->visibility, 0, 0);
-		UpdateVisibilityCode(neighbor->visibility, 1, 0);
+		int t = 0;
+		while (t < typeCount && types[t] != child->type) {
+			t++;
+		}
+		if (t == typeCount) {
+			types[typeCount] = child->type;
+			volumes[typeCount++] = 0.0f;
+		}
+		volumes[t] += child->fill;
 	}
 
-	// Back z neighbor
-	neighbor = GetNode(PosToLocCode(glm::u32vec3(pos.x, pos.y, pos.z - size), depth));
-	if (neighbor != nullptr) {
-		UpdateVisibilityCode(node->visibility, 1, 0);
-		UpdateVisibilityCode(neighbor->visibility, 0, 0);
+	// A node without children keeps its own block code and color
+	if (!hasChildren) {
+		node->isSolid = node->isLeaf;
+		node->fill = node->isLeaf ? 1.0f : 0.0f;
+		node->type = node->isLeaf ? node->id : 0;
+		return;
 	}
+	node->id = sum;
+	node->isSolid = solid;
+	node->fill = fill / 8.0f;
+	node->color = fill > 0.0f ? color / fill : glm::vec4(0.0f);
+	int majority = 0;
+	for (int t = 1; t < typeCount; t++) {
+		if (volumes[t] > volumes[majority]) {
+			majority = t;
+		}
+	}
+	node->type = types[majority];
 }
 
-inline void Octree::UpdateVisibilityCode(uint8_t &visibility, uint8_t n, bool val) {
-	visibility ^= (-val ^ visibility) & (1UL << n);
-	
-	// Update at least one face set bit
-	if (visibility & 63UL) {		// This would mean at least one face is set
-		visibility |= (1UL << 6);	// Set "at least one face" to true
-	}
-	else {
-		visibility = (uint8_t)0;
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::RemoveNode(LocCode_t LocCode) {
+	if (LocCode <= 1) {	// The root stays
+		return;
 	}
 
-	// Update at least all faces set bit
-	if ((visibility & 63UL) == 63) {	// This would mean all faces are set
-		visibility = 255;
+	if (GetNode(LocCode) == nullptr) {
 		return;
 	}
-	else {
-		visibility &= ~((uint8_t)1 << 7);	// Set "all faces" to false
+	// Also makes the path unique in a DAG, so Parent can be followed
+	OctreeNode* node = GetMutableNode(LocCode);
+
+	// Unlink first, so the removed nodes no longer count as neighbors of each other
+	OctreeNode* parent = node->Parent;
+	parent->Children[LocCode & 7] = nullptr;
+	ExposeFaces(node, LocCode);
+	DeleteNode(node);
+
+	// Walk back up, removing the ancestors that are now empty
+	LocCode_t removedLocCode = LocCode;
+	LocCode >>= 3;
+	while (parent != root) {
+		bool hasChildren = false;
+		for (int i = 0; i < 8; i++) {
+			if (parent->Children[i] != nullptr) {
+				hasChildren = true;
+				break;
+			}
+		}
+		if (hasChildren) {
+			break;
+		}
+
+		OctreeNode* grandParent = parent->Parent;
+		grandParent->Children[LocCode & 7] = nullptr;
+		ExposeFaces(LocCode);
+		DeleteNode(parent);
+		removedLocCode = LocCode;
+
+		parent = grandParent;
+		LocCode >>= 3;
+	}
+
+	UpdateIds(parent);
+	MarkDirty(removedLocCode);
+
+	if (isDAG) {
+		Recompress();
+	}
+}
+
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::UpdateVisibility(LocCode_t LocCode) {
+	CullFaces(LocCode);
+	if (isDAG) {
+		Recompress();
 	}
 }
 
-inline bool Octree::GetVisibilityCode(uint8_t& visibility, uint8_t n) {
-	return (visibility >> n) & 1U;
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::CullFaces(LocCode_t LocCode) {
+	// TODO: might not need this node here. Could create an overriding updatevisibility(loccode) function instead
+	OctreeNode* node = GetMutableNode(LocCode);
+	if (node == nullptr) return;
+	CullFaces(node);
 }
 
-void Octree::CreateMesh(Renderer * renderer, uint32_t LocCode, size_t detail) {
-	size_t depth = GetLocDepth(LocCode);
-	if (depth == Octree::MAXDEPTH) {
-		CreateMesh(renderer, LocCode);
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::CullFaces(OctreeNode* node) {
+	for (uint8_t face = 0; face < 6; face++) {
+		CullSharedFace(node, face);
+	}
+}
+
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::CullSharedFace(OctreeNode* node, uint8_t face) {
+	LocCode_t neighborLocCode;
+	OctreeNode* neighbor = GetNeighbor(node, face, neighborLocCode);
+	if (neighbor == nullptr) {
 		return;
 	}
+	UpdateVisibilityCode(node->visibility, face, 0);
 
-	// If we're at the required LOD, render
-	if (detail == 0) {
-		CreateMesh(renderer, LocCode);
+	// A larger neighbor is only partly covered by this node, so it keeps its face
+	if (GetLocDepth(neighborLocCode) != GetLocDepth(node->LocCode)) {
 		return;
 	}
 
-	// Else, move on and look for children. If no children, we render
-	OctreeNode* node = GetNode(LocCode);
+	// Only copy a shared neighbor if its face actually changes
+	if (GetVisibilityCode(neighbor->visibility, face ^ 1)) {
+		if (isDAG) {
+			neighbor = GetMutableNode(neighborLocCode);
+		}
+		UpdateVisibilityCode(neighbor->visibility, face ^ 1, 0);
+	}
 
-	// Check if this node is a leaf
-	bool hasChildren = false;
+	// A block also covers the smaller nodes on the other side, which see it as their larger neighbor
+	if (IsBlock(node)) {
+		UpdateFaceDescendants(neighbor, neighborLocCode, face ^ 1, 0);
+	}
+}
+
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::SplitBlock(LocCode_t LocCode) {
+	// Nothing else covered those faces: a same-sized node inside the block would have been a child
+	for (uint8_t face = 0; face < 6; face++) {
+		LocCode_t neighborLocCode = NeighborLocCode(LocCode, face);
+		OctreeNode* neighbor = GetNode(neighborLocCode);
+		if (neighbor != nullptr) {
+			UpdateFaceDescendants(neighbor, neighborLocCode, face ^ 1, 1);
+		}
+	}
+}
+
+template <typename LocCode_t>
+bool BasicOctree<LocCode_t>::IsBlock(OctreeNode* node) {
+	if (!node->isLeaf) {
+		return false;
+	}
 	for (int i = 0; i < 8; i++) {
 		if (node->Children[i] != nullptr) {
-			hasChildren = true;
+			return false;
 		}
 	}
+	return true;
+}
 
-	// If this is a leaf, we create the block
-	if (!hasChildren) {
-		CreateMesh(renderer, LocCode);
+template <typename LocCode_t>
+BasicOctreeNode<LocCode_t>* BasicOctree<LocCode_t>::GetNeighbor(OctreeNode* node, uint8_t face, LocCode_t& neighborLocCode) {
+	neighborLocCode = NeighborLocCode(node->LocCode, face);
+	if (neighborLocCode == 0) {
+		return nullptr;
+	}
+
+	// Both codes are equal above the highest bit that differs, which is where the paths to the two nodes split
+	uint32_t levels = Morton::HighestBit(node->LocCode ^ neighborLocCode) / 3 + 1;
+	OctreeNode* currentNode = node;
+	for (uint32_t i = 0; i < levels; i++) {
+		currentNode = currentNode->Parent;
+	}
+
+	for (int shift = 3 * levels - 3; shift >= 0; shift -= 3) {
+		OctreeNode* nextNode = currentNode->Children[(neighborLocCode >> shift) & 7];
+		if (nextNode == nullptr) {
+			// Stopped early: only a block covers the whole neighbor, a node with children is overridden by them
+			neighborLocCode >>= shift + 3;
+			return IsBlock(currentNode) ? currentNode : nullptr;
+		}
+		currentNode = nextNode;
+	}
+	return currentNode;
+}
+
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::ExposeFaces(LocCode_t LocCode) {
+	// Same neighbors as in CullFaces, but now only the neighbor changes
+	for (uint8_t face = 0; face < 6; face++) {
+		LocCode_t neighborLocCode = NeighborLocCode(LocCode, face);
+		if (neighborLocCode != 0) {
+			ExposeSharedFace(neighborLocCode, face ^ 1);
+		}
+	}
+}
+
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::ExposeFaces(OctreeNode* node, LocCode_t LocCode) {
+	ExposeFaces(LocCode);
+	for (int i = 0; i < 8; i++) {
+		if (node->Children[i] != nullptr) {
+			ExposeFaces(node->Children[i], (LocCode << 3) + i);
+		}
+	}
+}
+
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::ExposeSharedFace(LocCode_t neighborLocCode, uint8_t neighborFace) {
+	// NOTE: Looked up from the root, as the removed node's Parent is not reliable in a DAG
+	OctreeNode* neighbor = GetNode(neighborLocCode);
+	if (neighbor == nullptr) {
+		return;
+	}
+	if (!GetVisibilityCode(neighbor->visibility, neighborFace)) {
+		if (isDAG) {
+			neighbor = GetMutableNode(neighborLocCode);
+		}
+		UpdateVisibilityCode(neighbor->visibility, neighborFace, 1);
+	}
+	// Smaller nodes may have been culled against a removed block
+	UpdateFaceDescendants(neighbor, neighborLocCode, neighborFace, 1);
+}
+
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::UpdateFaceDescendants(OctreeNode* node, LocCode_t LocCode, uint8_t face, bool val) {
+	uint8_t axis = face >> 1;				// Bit of the child index that holds this axis
+	uint8_t side = (face & 1) ? 0 : 1;		// Children on the positive side for even faces
+	for (uint8_t i = 0; i < 8; i++) {
+		OctreeNode* child = node->Children[i];
+		if (child == nullptr || ((i >> axis) & 1) != side) {
+			continue;
+		}
+		LocCode_t childLocCode = (LocCode << 3) + i;
+		if (GetVisibilityCode(child->visibility, face) != val) {
+			if (isDAG) {
+				// NOTE: May copy the path, after which node is stale. It still has the old children, which is all we read
+				child = GetMutableNode(childLocCode);
+			}
+			UpdateVisibilityCode(child->visibility, face, val);
+		}
+		UpdateFaceDescendants(child, childLocCode, face, val);
+	}
+}
+
+template <typename LocCode_t>
+template <typename F>
+void BasicOctree<LocCode_t>::ForEachMeshNode(OctreeNode* node, LocCode_t LocCode, size_t detail, F& f, uint8_t childMask) {
+	// If we're at the required LOD, render
+	bool render = detail == 0 || GetLocDepth(LocCode) == BasicOctree::MAXDEPTH;
+
+	// Else, move on and look for children. If no children, we render
+	if (!render) {
+		render = true;
+		for (int i = 0; i < 8; i++) {
+			if (node->Children[i] != nullptr) {
+				render = false;
+				break;
+			}
+		}
+	}
+
+	if (render) {
+		f(node, LocCode);
 		return;
 	}
 
 	// Finally, if still not rendered, then clearly we must be rendering the available children at a higher LOD
+	// The children are followed directly, rather than looked up again by location code
+	// NOTE: The child LocCode is computed rather than read from the child, as children may be shared in a DAG
 	for (int i = 0; i < 8; i++) {
-		if (node->Children[i] == nullptr) { continue; }
-		Octree::CreateMesh(renderer, node->Children[i]->LocCode, detail - 1);
+		if (node->Children[i] == nullptr || !((childMask >> i) & 1U)) { continue; }
+		ForEachMeshNode(node->Children[i], (LocCode << 3) + i, detail - 1, f, childMask);
 	}
 }
 
-void Octree::CreateMesh(Renderer * renderer, uint32_t LocCode) {
-	uint32_t size = pow(2, (Octree::MAXDEPTH - GetLocDepth(LocCode)));	// Size of the cube
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::CreateMesh(Renderer * renderer, LocCode_t LocCode, size_t detail, MeshingMode mode, MeshScratch* scratch,
+	const size_t* neighborDetail) {
+	// The binary modes look for a larger block covering the LocCode themselves
+	bool binary = mode == MeshingMode_Binary || mode == MeshingMode_BinaryGreedy;
+	OctreeNode* node = GetNode(LocCode);
+	if (node == nullptr && !binary) {
+		return;
+	}
 
-	glm::vec3 pos = LocCodeToPos(LocCode);
+	// A packed vertex can only address so many units from the mesh origin
+	size_t depth = GetLocDepth(LocCode);
+	detail = std::min({ detail, (size_t)Renderer::MESHDEPTH, BasicOctree::MAXDEPTH - depth });
+	if (renderer->vertexArray.empty()) {
+		renderer->SetMeshOrigin(LocCodeToPos(LocCode), 1U << (BasicOctree::MAXDEPTH - depth - detail));
+	}
+
+	if (scratch == nullptr) {
+		scratch = &meshScratch;
+	}
+	if (binary) {
+		CreateBinaryMesh(renderer, LocCode, detail, mode == MeshingMode_BinaryGreedy, *scratch, neighborDetail);
+		return;
+	}
+
+	if (mode == MeshingMode_Greedy) {
+		glm::u32vec3 origin = renderer->GetMeshOrigin();
+		uint32_t unit = renderer->GetMeshUnit();
+		auto addCube = [&](OctreeNode* cube, LocCode_t cubeLocCode) {
+			uint32_t size = 1U << (BasicOctree::MAXDEPTH - GetLocDepth(cubeLocCode));
+			glm::u32vec3 pos = (LocCodeToPos(cubeLocCode) - origin) / unit;
+			scratch->greedy.AddCube(pos.x, pos.y, pos.z, size / unit, cube->visibility, BlockType(cube));
+		};
+		ForEachMeshNode(node, LocCode, detail, addCube);
+		scratch->greedy.CreateMesh(renderer);
+		return;
+	}
+
+	// Count the visible faces first, so the vertex array only has to grow once
+	size_t faces = 0;
+	auto countFaces = [&](OctreeNode* cube, LocCode_t) {
+		faces += Renderer::FaceCount(cube->visibility);
+	};
+	ForEachMeshNode(node, LocCode, detail, countFaces);
+	renderer->ReserveFaces(faces);
+
+	auto createCube = [&](OctreeNode* cube, LocCode_t cubeLocCode) {
+		uint32_t size = 1U << (BasicOctree::MAXDEPTH - GetLocDepth(cubeLocCode));	// Size of the cube
+		glm::vec3 pos = LocCodeToPos(cubeLocCode);
+		renderer->CreateCube(pos.x, pos.y, pos.z, size, cube->visibility, BlockType(cube));
+	};
+	ForEachMeshNode(node, LocCode, detail, createCube);
+}
+
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::CreateBinaryMesh(Renderer* renderer, LocCode_t LocCode, size_t detail, bool greedy, MeshScratch& scratch,
+	const size_t* neighborDetail) {
+	int32_t unit = (int32_t)renderer->GetMeshUnit();
+	glm::ivec3 nodePos = glm::ivec3(LocCodeToPos(LocCode));
+	scratch.binary.Clear(1U << detail);
+	auto addCube = [&](OctreeNode* cube, LocCode_t cubeLocCode) {
+		int32_t size = 1 << (BasicOctree::MAXDEPTH - GetLocDepth(cubeLocCode));
+		glm::ivec3 pos = (glm::ivec3(LocCodeToPos(cubeLocCode)) - nodePos) / unit;
+		scratch.binary.AddCube(pos.x, pos.y, pos.z, size / unit, BlockType(cube));
+	};
+
+	// A larger block is clipped to the box
+	LocCode_t nodeLocCode;
+	OctreeNode* node = GetCoveringNode(LocCode, nodeLocCode);
+	if (node == nullptr) {
+		return;
+	}
+	if (nodeLocCode != LocCode) {
+		addCube(node, nodeLocCode);
+	}
+	else {
+		ForEachMeshNode(node, LocCode, detail, addCube);
+	}
+
+	// The cells just outside of the node, so its border faces are culled too. Only the side of each neighbor facing
+	// this node is visited, i.e. the children whose bit for the axis of the face (bit face >> 1) points back at it
+	// The neighbor is visited at the detail of its own mesh. Cubes of a coarser one are simply clipped to the layer,
+	// cubes of a finer one only fill the cells whose face they cover completely
+	size_t maxDetail = std::min((size_t)Renderer::MESHDEPTH, BasicOctree::MAXDEPTH - (size_t)GetLocDepth(LocCode));
+	for (uint8_t face = 0; face < 6; face++) {
+		LocCode_t neighborLocCode = NeighborLocCode(LocCode, face);
+		if (neighborLocCode == 0) {
+			continue;
+		}
+		OctreeNode* neighbor = GetCoveringNode(neighborLocCode, nodeLocCode);
+		if (neighbor == nullptr) {
+			continue;
+		}
+		if (nodeLocCode != neighborLocCode) {
+			addCube(neighbor, nodeLocCode);
+			continue;
+		}
+
+		uint8_t childMask = 0;
+		for (uint8_t i = 0; i < 8; i++) {
+			if (((i >> (face >> 1)) & 1U) == (face & 1U)) {
+				childMask |= 1U << i;
+			}
+		}
+		size_t sideDetail = neighborDetail == nullptr ? detail : std::min(neighborDetail[face], maxDetail);
+		if (sideDetail <= detail) {
+			ForEachMeshNode(neighbor, neighborLocCode, sideDetail, addCube, childMask);
+			continue;
+		}
+
+		int32_t sideUnit = unit >> (sideDetail - detail);
+		auto addBorderCube = [&](OctreeNode*, LocCode_t cubeLocCode) {
+			int32_t size = 1 << (BasicOctree::MAXDEPTH - GetLocDepth(cubeLocCode));
+			glm::ivec3 pos = (glm::ivec3(LocCodeToPos(cubeLocCode)) - nodePos) / sideUnit;
+			scratch.binary.AddBorderCube(pos.x, pos.y, pos.z, size / sideUnit);
+		};
+		scratch.binary.BeginBorder(2 - (face >> 1), 1U << (sideDetail - detail));
+		ForEachMeshNode(neighbor, neighborLocCode, sideDetail, addBorderCube, childMask);
+		scratch.binary.EndBorder((face & 1) ? -1 : (1 << detail));
+	}
+
+	glm::u32vec3 offset = (LocCodeToPos(LocCode) - renderer->GetMeshOrigin()) / (uint32_t)unit;
+	if (greedy) {
+		scratch.binary.AddFaces(scratch.greedy, offset);
+		scratch.greedy.CreateMesh(renderer);
+	}
+	else {
+		scratch.binary.CreateMesh(renderer, offset);
+	}
+}
+
+template <typename LocCode_t>
+BasicOctreeNode<LocCode_t>* BasicOctree<LocCode_t>::GetCoveringNode(LocCode_t LocCode, LocCode_t& nodeLocCode) {
+	// Walked down from the root rather than with GetNeighbor(), as Parent can't be followed in a DAG
+	uint32_t depth = GetLocDepth(LocCode);
+	OctreeNode* node = root;
+	for (uint32_t level = 1; level <= depth; level++) {
+		OctreeNode* next = node->Children[(LocCode >> (3 * (depth - level))) & 7];
+		if (next == nullptr) {
+			// Stopped early: only a block covers the rest
+			nodeLocCode = LocCode >> (3 * (depth - level + 1));
+			return IsBlock(node) ? node : nullptr;
+		}
+		node = next;
+	}
+	nodeLocCode = LocCode;
+	return node;
+}
 
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::CreateMesh(Renderer * renderer, LocCode_t LocCode) {
 	OctreeNode* node = GetNode(LocCode);
+	if (node == nullptr) {
+		return;
+	}
+	uint32_t size = 1U << (BasicOctree::MAXDEPTH - GetLocDepth(LocCode));	// Size of the cube
+	glm::vec3 pos = LocCodeToPos(LocCode);
+	renderer->CreateCube(pos.x, pos.y, pos.z, size, node->visibility, BlockType(node));
+}
 
-	// TODO: see if you really need to search for the node again here
-	renderer->CreateCube(pos.x, pos.y, pos.z, size, node->visibility);
+template <typename LocCode_t>
+uint16_t BasicOctree<LocCode_t>::BlockType(OctreeNode* node) {
+	// Only a block's id is its block code. Other nodes have the sum of the codes inside of them, but keep the most
+	// common one in type
+	return IsBlock(node) ? node->id : node->type;
 }
 
-void Octree::StageMesh(Renderer * renderer) {
-	renderer->StageMesh(1, 1);
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::StageMesh(Renderer * renderer) {
+	renderer->UploadMesh();
 }
 
-void Octree::Render(Renderer * renderer, Camera camera, const unsigned int WIDTH, const unsigned int HEIGHT) {
-	renderer->RenderMesh(&blockShader, camera, WIDTH, HEIGHT);
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::Render(Renderer * renderer, Camera camera, const unsigned int WIDTH, const unsigned int HEIGHT) {
+	renderer->RenderMesh(&BlockShader::blocks(), camera, WIDTH, HEIGHT);
 }
 
-void Octree::InsertRandomNodes(Renderer* renderer, size_t depth=Octree::MAXDEPTH) {
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::InsertRandomNodes(Renderer* renderer, size_t depth) {
 	InsertRandomNodes(renderer, root, depth);
 }
 
-void Octree::InsertRandomNodes(Renderer * renderer, OctreeNode* node, size_t depth=Octree::MAXDEPTH) {
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::InsertRandomNodes(Renderer * renderer, OctreeNode* node, size_t depth) {
 	if (GetLocDepth(node->LocCode) == depth) {
 		return;
 	}
@@ -246,7 +690,7 @@ void Octree::InsertRandomNodes(Renderer * renderer, OctreeNode* node, size_t dep
 
 		if (node->Children[i] == nullptr) {
 			//node->Children[i] = new OctreeNode();
-			uint32_t LocCode = ((node->LocCode) << 3) + (i);
+			LocCode_t LocCode = ((node->LocCode) << 3) + (i);
 			InsertNode(LocCode, glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
 		}
 	}
@@ -258,33 +702,405 @@ void Octree::InsertRandomNodes(Renderer * renderer, OctreeNode* node, size_t dep
 	}
 }
 
-inline glm::u32vec3 Octree::LocCodeToPos(uint32_t LocCode) {
-	uint32_t x = 0, y = 0, z = 0;
-	size_t depth = GetLocDepth(LocCode);
-	for (int i = 0; i < depth; i++) {
-		x += (bool)(LocCode & (1 << (i * 3 + 2))) << (Octree::MAXDEPTH - depth + i);
-		y += (bool)(LocCode & (1 << (i * 3 + 1))) << (Octree::MAXDEPTH - depth + i);
-		z += (bool)(LocCode & (1 << (i * 3 + 0))) << (Octree::MAXDEPTH - depth + i);
+template <typename LocCode_t>
+DAGStats BasicOctree<LocCode_t>::CompressToDAG() {
+	DAGStats stats;
+	stats.nodesBefore = NodeCount();
+	if (isDAG) {	// Edits keep the tree compressed, nothing left to merge
+		stats.nodesAfter = stats.nodesBefore;
+		return stats;
 	}
-	return glm::u32vec3(x, y, z);
+
+	EnableIndex(false);
+	Canonicalize(root);
+	isDAG = true;
+
+	stats.nodesAfter = NodeCount();
+	stats.bytesSaved = (stats.nodesBefore - stats.nodesAfter) * sizeof(OctreeNode);
+	return stats;
 }
 
-inline uint32_t Octree::PosToLocCode(glm::u32vec3 pos, size_t depth) {
-	if (std::max({ pos.x, pos.y, pos.z }) >= pow(2, Octree::MAXDEPTH + 1)) {
-		return NULL;
+template <typename LocCode_t>
+BasicOctreeNode<LocCode_t>* BasicOctree<LocCode_t>::Canonicalize(OctreeNode* node) {
+	// Post-order, so the children are canonical by the time we compare this node
+	for (int i = 0; i < 8; i++) {
+		if (node->Children[i] != nullptr) {
+			node->Children[i] = Canonicalize(node->Children[i]);
+		}
 	}
 
-	if (std::min({ pos.x, pos.y, pos.z }) < 0) {
-		return NULL;
+	if (node == root) {	// The root is never shared
+		return node;
 	}
 
-	uint32_t LocCode = 1 << depth * 3;
+	// The id is only a first guess, different subtrees often have the same sum
+	auto candidates = DAGhash.equal_range(node->id);
+	for (auto it = candidates.first; it != candidates.second; ++it) {
+		if (IsSameNode(it->second, node)) {
+			OctreeNode* shared = it->second;
+			shared->refCount++;
+			DeleteNode(node);	// Only drops this node, its children are still used by the shared node
+			return shared;
+		}
+	}
 
-	for (int i = 0; i < depth; i++) {
-		LocCode += (1 << (depth * 3 - 3 * i - 1)) * bool(1 & (pos.x >> (10 - i - 1)));
-		LocCode += (1 << (depth * 3 - 3 * i - 2)) * bool(1 & (pos.y >> (10 - i - 1)));
-		LocCode += (1 << (depth * 3 - 3 * i - 3)) * bool(1 & (pos.z >> (10 - i - 1)));
+	DAGhash.emplace(node->id, node);
+	return node;
+}
+
+template <typename LocCode_t>
+BasicOctreeNode<LocCode_t>* BasicOctree<LocCode_t>::GetMutableNode(LocCode_t LocCode) {
+	if (!isDAG) {
+		return GetNode(LocCode);
+	}
+	if (LocCode == 0) {
+		return nullptr;
+	}
+
+	// Remembered up front: even if the node turns out not to exist, the part of the path that does was unhashed
+	editedLocCodes.push_back(LocCode);
+
+	uint32_t depth = GetLocDepth(LocCode);
+	unsigned short shift = depth * 3 - 3;
+	OctreeNode* currentNode = root;
+	for (uint32_t i = 0; i < depth; i++) {
+		if (currentNode->Children[(LocCode >> shift) & 7] == nullptr) {
+			return nullptr;
+		}
+		currentNode = MakeUnique(currentNode, (LocCode >> shift) & 7);
+		shift -= 3;
+	}
+	return currentNode;
+}
+
+template <typename LocCode_t>
+BasicOctreeNode<LocCode_t>* BasicOctree<LocCode_t>::MakeUnique(OctreeNode* node, uint8_t i) {
+	OctreeNode* child = node->Children[i];
+	if (child->refCount > 1) {
+		// Shared, so give this location its own copy. The copy shares the grandchildren
+		OctreeNode* copy = nodePool.Allocate(*child);
+		copy->refCount = 1;
+		for (int j = 0; j < 8; j++) {
+			if (copy->Children[j] != nullptr) {
+				copy->Children[j]->refCount++;
+			}
+		}
+		child->refCount--;
+		node->Children[i] = copy;
+		child = copy;
+	}
+	else {
+		Unhash(child);	// About to change, so it can't be found by its old contents anymore
+	}
+
+	// Only used at this location now, so these are well-defined again
+	child->Parent = node;
+	child->LocCode = (node->LocCode << 3) + i;
+	return child;
+}
+
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::Recompress() {
+	// Every ancestor of a changed node has changed as well
+	std::vector<LocCode_t> LocCodes;
+	for (LocCode_t LocCode : editedLocCodes) {
+		for (; LocCode > 1; LocCode >>= 3) {
+			LocCodes.push_back(LocCode);
+		}
+	}
+	editedLocCodes.clear();
+
+	// Deeper nodes have larger location codes, so this handles children before their parents
+	std::sort(LocCodes.begin(), LocCodes.end(), std::greater<LocCode_t>());
+	LocCodes.erase(std::unique(LocCodes.begin(), LocCodes.end()), LocCodes.end());
+
+	for (LocCode_t LocCode : LocCodes) {
+		OctreeNode* parent = GetNode(LocCode >> 3);
+		if (parent == nullptr || parent->Children[LocCode & 7] == nullptr) {
+			continue;	// Removed since
+		}
+		OctreeNode* node = parent->Children[LocCode & 7];
+
+		OctreeNode* shared = nullptr;
+		auto candidates = DAGhash.equal_range(node->id);
+		for (auto it = candidates.first; it != candidates.second; ++it) {
+			if (it->second != node && IsSameNode(it->second, node)) {
+				shared = it->second;
+				break;
+			}
+		}
+
+		if (shared == nullptr) {
+			Unhash(node);	// In case an earlier location code already hashed this node
+			DAGhash.emplace(node->id, node);
+			continue;
+		}
+		shared->refCount++;
+		parent->Children[LocCode & 7] = shared;
+		DeleteNode(node);
+	}
+}
+
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::Unhash(OctreeNode* node) {
+	auto candidates = DAGhash.equal_range(node->id);
+	for (auto it = candidates.first; it != candidates.second; ++it) {
+		if (it->second == node) {
+			DAGhash.erase(it);
+			return;
+		}
+	}
+}
+
+template <typename LocCode_t>
+bool BasicOctree<LocCode_t>::IsSameNode(OctreeNode* a, OctreeNode* b) {
+	if (a->id != b->id || a->isLeaf != b->isLeaf || a->visibility != b->visibility || a->color != b->color) {
+		return false;
+	}
+	// Children are canonical already, so equal subtrees means equal pointers
+	for (int i = 0; i < 8; i++) {
+		if (a->Children[i] != b->Children[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+template <typename LocCode_t>
+size_t BasicOctree<LocCode_t>::NodeCount() {
+	return nodePool.Size();
+}
+
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::EnableIndex(bool enable) {
+	if (!enable || isDAG) {
+		index.Clear();
+		isIndexed = false;
+		return;
+	}
+	if (isIndexed) {
+		return;
+	}
+	index.Reserve(NodeCount());
+	IndexNodes(root);
+	isIndexed = true;
+}
+
+template <typename LocCode_t>
+bool BasicOctree<LocCode_t>::IsIndexed() {
+	return isIndexed;
+}
+
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::TrackChunks(uint32_t chunkLevels) {
+	this->chunkLevels = std::min(chunkLevels, (uint32_t)BasicOctree::MAXDEPTH);
+	dirtyChunks.clear();
+	if (chunkLevels > 0) {
+		dirtyChunks.insert(1);
+	}
+}
+
+template <typename LocCode_t>
+uint32_t BasicOctree<LocCode_t>::GetChunkDepth() {
+	return BasicOctree::MAXDEPTH - chunkLevels;
+}
+
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::TakeDirtyChunks(std::vector<LocCode_t>& chunks) {
+	chunks.insert(chunks.end(), dirtyChunks.begin(), dirtyChunks.end());
+	dirtyChunks.clear();
+}
+
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::MarkDirty(LocCode_t LocCode) {
+	if (chunkLevels == 0) {
+		return;
+	}
+	uint32_t depth = GetLocDepth(LocCode);
+	uint32_t shift = depth > GetChunkDepth() ? 3 * (depth - GetChunkDepth()) : 0;
+	LocCode_t chunk = LocCode >> shift;
+	dirtyChunks.insert(chunk);
+
+	// The neighbor of the node only lies in another chunk if the node is against that face of its chunk
+	for (uint8_t face = 0; face < 6; face++) {
+		LocCode_t neighborLocCode = NeighborLocCode(LocCode, face);
+		if (neighborLocCode != 0 && (neighborLocCode >> shift) != chunk) {
+			dirtyChunks.insert(neighborLocCode >> shift);
+		}
 	}
+}
 
-	return LocCode;
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::GetChunks(LocCode_t LocCode, std::vector<LocCode_t>& chunks) {
+	uint32_t depth = GetLocDepth(LocCode);
+	if (depth >= GetChunkDepth()) {
+		chunks.push_back(LocCode >> (3 * (depth - GetChunkDepth())));
+		return;
+	}
+
+	LocCode_t nodeLocCode;
+	OctreeNode* node = GetCoveringNode(LocCode, nodeLocCode);
+	if (node == nullptr) {
+		return;
+	}
+	if (nodeLocCode != LocCode) {
+		AddBlockChunks(nodeLocCode, LocCode, chunks);
+		return;
+	}
+	AddChunks(node, LocCode, chunks);
 }
+
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::AddChunks(OctreeNode* node, LocCode_t LocCode, std::vector<LocCode_t>& chunks) {
+	if (GetLocDepth(LocCode) == GetChunkDepth()) {
+		chunks.push_back(LocCode);
+		return;
+	}
+	if (IsBlock(node)) {
+		AddBlockChunks(LocCode, LocCode, chunks);
+		return;
+	}
+	for (int i = 0; i < 8; i++) {
+		if (node->Children[i] != nullptr) {
+			AddChunks(node->Children[i], (LocCode << 3) + i, chunks);
+		}
+	}
+}
+
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::AddBlockChunks(LocCode_t blockLocCode, LocCode_t LocCode, std::vector<LocCode_t>& chunks) {
+	if (!OnBlockBorder(blockLocCode, LocCode)) {
+		return;
+	}
+	if (GetLocDepth(LocCode) == GetChunkDepth()) {
+		chunks.push_back(LocCode);
+		return;
+	}
+	for (int i = 0; i < 8; i++) {
+		AddBlockChunks(blockLocCode, (LocCode << 3) + i, chunks);
+	}
+}
+
+template <typename LocCode_t>
+bool BasicOctree<LocCode_t>::OnBlockBorder(LocCode_t blockLocCode, LocCode_t LocCode) {
+	glm::u32vec3 blockPos = LocCodeToPos(blockLocCode);
+	glm::u32vec3 blockEnd = blockPos + glm::u32vec3(1U << (BasicOctree::MAXDEPTH - GetLocDepth(blockLocCode)));
+	glm::u32vec3 pos = LocCodeToPos(LocCode);
+	glm::u32vec3 end = pos + glm::u32vec3(1U << (BasicOctree::MAXDEPTH - GetLocDepth(LocCode)));
+	bool border = false;
+	for (int axis = 0; axis < 3; axis++) {
+		border = border || pos[axis] == blockPos[axis] || end[axis] == blockEnd[axis];
+	}
+	return border;
+}
+
+template <typename LocCode_t>
+size_t BasicOctree<LocCode_t>::GetVisibleChunks(const Frustum& frustum, std::vector<LocCode_t>& chunks) {
+	size_t tested = 0;
+	AddVisibleChunks(root, 1, 0, frustum, Frustum::ALLPLANES, chunks, tested);
+	return tested;
+}
+
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::AddVisibleChunks(OctreeNode* node, LocCode_t LocCode, LocCode_t blockLocCode,
+	const Frustum& frustum, uint8_t planeMask, std::vector<LocCode_t>& chunks, size_t& tested) {
+	if (blockLocCode != 0 && !OnBlockBorder(blockLocCode, LocCode)) {
+		return;	// The inside of a block has no faces
+	}
+
+	glm::vec3 pos = LocCodeToPos(LocCode);
+	float size = (float)(1U << (BasicOctree::MAXDEPTH - GetLocDepth(LocCode)));
+	tested++;
+	if (frustum.TestBox(pos, pos + glm::vec3(size), planeMask) == FrustumTest_Outside) {
+		return;
+	}
+	if (planeMask == 0) {
+		// Fully inside, so is everything below
+		if (blockLocCode != 0) {
+			AddBlockChunks(blockLocCode, LocCode, chunks);
+		}
+		else {
+			AddChunks(node, LocCode, chunks);
+		}
+		return;
+	}
+	if (GetLocDepth(LocCode) == GetChunkDepth()) {
+		chunks.push_back(LocCode);
+		return;
+	}
+
+	if (blockLocCode == 0 && IsBlock(node)) {
+		blockLocCode = LocCode;
+	}
+	for (int i = 0; i < 8; i++) {
+		if (blockLocCode != 0) {
+			AddVisibleChunks(node, (LocCode << 3) + i, blockLocCode, frustum, planeMask, chunks, tested);
+		}
+		else if (node->Children[i] != nullptr) {
+			AddVisibleChunks(node->Children[i], (LocCode << 3) + i, 0, frustum, planeMask, chunks, tested);
+		}
+	}
+}
+
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::GetOccluders(const Frustum& frustum, glm::vec3 eye, float minSize, size_t maxCount,
+	std::vector<glm::vec4>& occluders) {
+	if (occluders.size() < maxCount) {
+		AddOccluders(root, 1, frustum, Frustum::ALLPLANES, eye, minSize, maxCount, occluders);
+	}
+}
+
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::AddOccluders(OctreeNode* node, LocCode_t LocCode, const Frustum& frustum, uint8_t planeMask,
+	glm::vec3 eye, float minSize, size_t maxCount, std::vector<glm::vec4>& occluders) {
+	glm::vec3 pos = LocCodeToPos(LocCode);
+	float size = (float)(1U << (BasicOctree::MAXDEPTH - GetLocDepth(LocCode)));
+	glm::vec3 end = pos + glm::vec3(size);
+
+	// Everything inside is at most this wide, and at least this far away
+	glm::vec3 offset = glm::max(glm::max(pos - eye, eye - end), glm::vec3(0.0f));
+	float distance = glm::length(offset);
+	if (size < minSize * distance) {
+		return;
+	}
+	if (planeMask != 0 && frustum.TestBox(pos, end, planeMask) == FrustumTest_Outside) {
+		return;
+	}
+	if (node->isSolid) {
+		occluders.push_back(glm::vec4(pos, size));
+		return;
+	}
+
+	// Children front to back: the one on the side of the eye first, the one opposite of it last. Counting up and
+	// flipping the bits of that first child never puts a child before one that lies between it and the eye
+	glm::vec3 center = pos + glm::vec3(size / 2);
+	uint8_t nearest = (eye.x >= center.x ? 4 : 0) | (eye.y >= center.y ? 2 : 0) | (eye.z >= center.z ? 1 : 0);
+	for (uint8_t i = 0; i < 8 && occluders.size() < maxCount; i++) {
+		uint8_t child = i ^ nearest;
+		if (node->Children[child] != nullptr) {
+			AddOccluders(node->Children[child], (LocCode << 3) + child, frustum, planeMask, eye, minSize, maxCount, occluders);
+		}
+	}
+}
+
+template <typename LocCode_t>
+void BasicOctree<LocCode_t>::IndexNodes(OctreeNode* node) {
+	index.Insert(node->LocCode, node);
+	for (int i = 0; i < 8; i++) {
+		if (node->Children[i] != nullptr) {
+			IndexNodes(node->Children[i]);
+		}
+	}
+}
+
+template <typename LocCode_t>
+BasicOctreeNode<LocCode_t>* BasicOctree<LocCode_t>::CreateChild(OctreeNode* node, uint8_t i) {
+	OctreeNode* child = nodePool.Allocate(node, (node->LocCode << 3) + i);
+	if (isIndexed) {
+		index.Insert(child->LocCode, child);
+	}
+	return child;
+}
+
+template class BasicOctree<uint32_t>;
+template class BasicOctree<uint64_t>;
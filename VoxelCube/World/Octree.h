@@ -7,55 +7,143 @@
 * This ID is used to aid in the process of adding/removing blocks
 * 
 * The DAGhash tells us, given an ID, candidate chunks.
+* CompressToDAG() uses it to merge identical subtrees, after which a node can have several parents. Reading (GetNode,
+* CreateMesh) works on the shared nodes, since it only ever follows Children. The LocCode and Parent stored in a shared
+* node belong to just one of the places it is used, so don't rely on them after compressing.
+* Edits on the compressed tree are copy-on-write: the path from the root to every node that changes is copied where it
+* is shared, and re-hashed into the DAGhash afterwards. Reference counts free subtrees that are no longer used.
 * 
 * The location code is borrowed from linear hashed octrees, and it implicitly stores the depth of a node
+* Optionally, the tree also keeps the hash table of a linear hashed octree (see EnableIndex), so that GetNode is a
+* single probe instead of a walk down from the root
 * A location is an element in 1{0, 1}^{3n}, where going right in the code corresponds to a higher level of detail
+* 
+* The octree is a template on the type of the location code. The width of it sets the maximum depth, as the code needs
+* 3 bits per level plus the leading 1: Octree uses 32-bit codes (depth 10, 1024^3 blocks), Octree64 uses 64-bit codes
+* (depth 21, 2097152^3 blocks). Positions stay 32-bit either way
 */
 
 #include "glm/glm.hpp"
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <type_traits>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "../Core/Frustum.h"
 #include "../Core/Renderer.h"
+#include "BinaryMesher.h"
+#include "GreedyMesher.h"
+#include "Morton.h"
+#include "LocCodeTable.h"
+#include "NodePool.h"
 
-/* Not compact, but elegant enough */
-struct OctreeNode {
-	OctreeNode* Children[8] = { nullptr };
-	OctreeNode* Parent = { nullptr };
+/* Not compact, but elegant enough (see CompactOctree for the compact version) */
+template <typename LocCode_t>
+struct BasicOctreeNode {
+	BasicOctreeNode* Children[8] = { nullptr };
+	BasicOctreeNode* Parent = { nullptr };
 	uint16_t id = 0;	// Implicitly contains the block code at leafs. Otherwise the sum of all block codes in the node.
-	uint32_t LocCode;
-	glm::vec4 color;
+	uint16_t type = 0;	// The block code at blocks. Otherwise the one that fills most of the node, see Summarize()
+	LocCode_t LocCode;
+	glm::vec4 color = glm::vec4(0.0f);	// Set at blocks. Otherwise the average color of the blocks in the node, weighted by their volume
 	bool isLeaf = false;
+	bool isSolid = false;	// Filled with blocks throughout: a block, or a node whose 8 children are all solid
+	float fill = 0.0f;	// Fraction of the node's volume filled with blocks. 1 exactly when it is solid
 	uint8_t visibility = (uint8_t)(255);	// Visibility bitmask. Order is: all_faces, at_least_one_face, x_small, x_big, y_small, y_big, z_small, z_big
-	OctreeNode(OctreeNode* p, uint32_t LocCode) : Parent(p),LocCode(LocCode) { };
+	uint32_t refCount = 1;	// Number of parents pointing to this node. Only ever above 1 in a DAG
+	BasicOctreeNode(BasicOctreeNode* p, LocCode_t LocCode) : Parent(p),LocCode(LocCode) { };
+};
+
+typedef BasicOctreeNode<uint32_t> OctreeNode;
+
+/* A single voxel for Octree::InsertBatch() */
+template <typename LocCode_t>
+struct BasicVoxelInsert {
+	LocCode_t LocCode;
+	glm::vec4 color;
+	uint16_t id = 1;
 };
 
-class Octree {
-static const unsigned short MAXDEPTH = 10;
-BlockShader blockShader = BlockShader("Core/VertexShader.txt", "Core/FragmentShader.txt");
+typedef BasicVoxelInsert<uint32_t> VoxelInsert;
+
+/* Result of Octree::CompressToDAG() */
+struct DAGStats {
+	size_t nodesBefore = 0;
+	size_t nodesAfter = 0;
+	size_t bytesSaved = 0;
+};
+
+/* How Octree::CreateMesh() turns the blocks into faces */
+enum MeshingMode {
+	MeshingMode_Naive = 0,	// Every visible face of every block is its own quad
+	MeshingMode_Greedy = 1,	// Coplanar faces of the same type are merged into rectangles, see GreedyMesher
+	MeshingMode_Binary = 2,	// Faces are culled on occupancy bitmasks rather than the visibility bits, see BinaryMesher
+	MeshingMode_BinaryGreedy = 3,	// Culled on bitmasks, then merged
+};
+
+/* Scratch space of the greedy and binary meshers. CreateMesh() only reads the tree, so several threads can mesh at
+once, as long as each has its own scratch space and renderer and nothing edits the tree meanwhile */
+struct MeshScratch {
+	GreedyMesher greedy;
+	BinaryMesher binary;
+};
+
+template <typename LocCode_t>
+class BasicOctree {
+static_assert(std::is_unsigned<LocCode_t>::value, "Location codes are unsigned integers");
+static const unsigned short MAXDEPTH = (sizeof(LocCode_t) * 8 - 1) / 3;	// 3 bits per level, plus the leading 1
 
 public:
-	Octree();
-	~Octree();
+	typedef BasicOctreeNode<LocCode_t> OctreeNode;
+	typedef BasicVoxelInsert<LocCode_t> VoxelInsert;
 
-	void DeleteNode(uint32_t LocCode);
+	BasicOctree();
+	~BasicOctree();
 
+	void DeleteNode(LocCode_t LocCode);
+
+	/* Delete a node and all of its children, returning them to the node pool
+	In a DAG, this drops one reference, and only nodes that are no longer used are deleted */
 	void DeleteNode(OctreeNode* node);
 
-	/* Gets a node. If the node does not exist, returns a nullptr */
-	OctreeNode* GetNode(uint32_t LocCode);
+	/* Gets a node. If the node does not exist, returns a nullptr
+	With the index enabled this is a single hash table probe, otherwise O(depth) */
+	OctreeNode* GetNode(LocCode_t LocCode);
+
+	/* Insert a node into the octree. NOTE: Currently overwrites existing nodes
+	The id is the block code of the node. The ids of all ancestors are updated to stay the sum of their children */
+	void InsertNode(LocCode_t LocCode, glm::vec4 color, uint16_t id = 1);
 
-	/* Insert a node into the octree. NOTE: Currently overwrites existing nodes */
-	void InsertNode(uint32_t LocCode, glm::vec4 color);
+	/* Insert many nodes at once. Gives the same tree as calling InsertNode for each of them in order, but the voxels
+	are sorted in Morton order (which is why the vector is taken by reference) so the path down from the root is shared
+	between consecutive voxels, and the faces are culled in one sweep over the new nodes at the end
+	In a DAG, this falls back to InsertNode */
+	void InsertBatch(std::vector<VoxelInsert>& voxels);
 
-	/* Remove nodes. TODO: Implement this*/
-	void RemoveNode(uint32_t LocCode);
+	/* Remove a node and everything in it. Ancestors left without children are removed as well, the ids of the
+	remaining ancestors are updated, and the faces of the neighbors that were culled against the removed nodes are
+	shown again. Removing a leaf costs O(depth), removing a bigger node also visits everything inside of it */
+	void RemoveNode(LocCode_t LocCode);
 
 	/* Adds a mesh at a given level of detail. A detail of 0 means just one block for this node.
-	A detail of 1 means 8 blocks inside the node are also seen etc. */
-	void CreateMesh(Renderer * renderer, uint32_t LocCode, size_t detail);
+	A detail of 1 means 8 blocks inside the node are also seen etc.
+	NOTE: The detail is capped at Renderer::MESHDEPTH, as a mesh is limited to 32 units per axis. When the mesh is empty,
+	its origin is set to this node, otherwise the cubes are added relative to the origin that was there
+	Greedy meshing only merges faces within this call, and needs the node to lie inside the mesh box. The binary modes
+	cull every face between two filled cells, so they can differ from the visibility bits where nodes of different
+	sizes meet. They also mesh a LocCode without a node, if it lies inside a larger block
+	Without scratch space, the tree's own is used, so only one thread can mesh at a time
+	For the binary modes, neighborDetail can give the detail that the neighbor across each face (numbered as in
+	NeighborLocCode) is meshed at, so the faces on the border of meshes of different detail line up without cracks:
+	a face is only culled where the neighbor's own mesh covers all of it. Without it, the neighbors have this detail */
+	void CreateMesh(Renderer * renderer, LocCode_t LocCode, size_t detail, MeshingMode mode = MeshingMode_Naive,
+		MeshScratch* scratch = nullptr, const size_t* neighborDetail = nullptr);
 	
-	/* Add a block to the renderer, without considering child nodes */
-	void CreateMesh(Renderer * renderer, uint32_t LocCode);
+	/* Add a block to the renderer, without considering child nodes. Relative to the current mesh origin */
+	void CreateMesh(Renderer * renderer, LocCode_t LocCode);
 	
 	/* Stage the mesh... NOTE: this appends(!) to the mesh vector*/
 	void StageMesh(Renderer* renderer);
@@ -67,30 +155,278 @@ public:
 	/* Render the blocks that were staged by createMesh() */
 	void Render(Renderer* renderer, Camera camera, const unsigned int WIDTH, const unsigned int HEIGHT);
 
-	/* Updates the visibility of a node at the LocCode */
-	void UpdateVisibility(uint32_t LocCode);
+	/* Updates the visibility of a node at the LocCode
+	A face is culled when the neighbor on that side is a node of the same size, or a larger block (a leaf without
+	children). A larger neighbor keeps its own face, as the node only covers part of it */
+	void UpdateVisibility(LocCode_t LocCode);
+
+	/* Merges identical subtrees bottom-up, turning the tree into a DAG
+	Subtrees are looked up in the DAGhash by id and compared node by node on a collision
+	Afterwards, InsertNode and UpdateVisibility keep the tree compressed by editing copy-on-write */
+	DAGStats CompressToDAG();
+
+	/* Number of nodes in the tree, the root included. Shared nodes count once */
+	size_t NodeCount();
+
+	/* Keep a hash table from location code to node, synced on every insert and remove. Costs about 2 location codes and
+	2 pointers of memory per node. Enabling builds the table from the current tree
+	NOTE: Not available in a DAG, where a node can be at many locations. CompressToDAG() drops the index */
+	void EnableIndex(bool enable);
+	bool IsIndexed();
+
+	/* Keep track of the chunks that change, so their meshes can be rebuilt (see ChunkManager). A chunk is a node with
+	chunkLevels levels of blocks below it, 0 turns tracking off. Enabling marks the whole tree as changed */
+	void TrackChunks(uint32_t chunkLevels);
+
+	/* Depth of the chunk nodes, see TrackChunks() */
+	uint32_t GetChunkDepth();
+
+	/* Append the chunks changed by InsertNode(), InsertBatch() and RemoveNode() since the last call, and forget them
+	A chunk is marked along with the chunks next to it that the edit touches, as their border faces change too. An
+	edit of a node bigger than a chunk is reported as the LocCode of that node, see GetChunks() */
+	void TakeDirtyChunks(std::vector<LocCode_t>& chunks);
+
+	/* Append the chunks inside the node (or the chunk the node is in) that have anything to mesh: the chunk nodes that
+	exist, and the chunks along the border of a block bigger than a chunk, as its inside has no faces */
+	void GetChunks(LocCode_t LocCode, std::vector<LocCode_t>& chunks);
+
+	/* Append the chunks of GetChunks(1) whose box is at least partly inside the frustum, walking down from the root
+	Subtrees outside the frustum are skipped, and subtrees fully inside are taken without testing anything below them.
+	Returns the number of boxes tested. Works in a DAG */
+	size_t GetVisibleChunks(const Frustum& frustum, std::vector<LocCode_t>& chunks);
+
+	/* Append the solid nodes (see isSolid) in the frustum that are at least minSize wide per unit of distance from the
+	eye, nearest first, until there are maxCount of them. Each is its position, with its width in w. These are the boxes
+	that hide the most of the view, for use as occluders (see OcclusionCuller). Works in a DAG */
+	void GetOccluders(const Frustum& frustum, glm::vec3 eye, float minSize, size_t maxCount, std::vector<glm::vec4>& occluders);
 
 	/* Get a position from a location code */
-	inline glm::u32vec3 LocCodeToPos(uint32_t LocCode);
+	static glm::u32vec3 LocCodeToPos(LocCode_t LocCode);
 
 	/* Gets a location code from a position
 	Recall that different sized blocks can be found at a position, hence the need for the depth
 	NOTE: Requires a valid LocCode to work, otherwise returns garbage */
-	inline uint32_t PosToLocCode(glm::u32vec3, size_t depth);
-	
-private:
-	OctreeNode * root;
+	static LocCode_t PosToLocCode(glm::u32vec3, size_t depth);
+
+	/* Location code of the node of the same size on the other side of a face. Faces are numbered like the bits of the
+	visibility bitmask, so the opposite face is face ^ 1
+	Works on the code directly: the bits of one axis are incremented or decremented, with the carry running through
+	the interleaved bits of the other axes. Returns 0 at the edge of the world */
+	static LocCode_t NeighborLocCode(LocCode_t LocCode, uint8_t face);
 
 	/* Get the depth of the voxel corresponding to the location code
 	The depth is relative to the root node, which has depth 0
 	Example: GetLocDepth(...0001011001) = 2*/
-	uint32_t GetLocDepth(uint32_t LocCode);
-	std::unordered_map<uint32_t, OctreeNode*> DAGhash;
+	static uint32_t GetLocDepth(LocCode_t LocCode);
+	
+private:
+	friend class CompactOctree;	// Shares the location code and visibility helpers
+
+	NodePool<OctreeNode> nodePool;	// Owns every node of this tree
+	LocCodeTable<LocCode_t, OctreeNode> index;	// LocCode -> node, if isIndexed
+	bool isIndexed = false;
+	MeshScratch meshScratch;	// Scratch grids for the greedy and binary modes, kept between meshes
+	OctreeNode * root;
+
+	std::unordered_multimap<uint32_t, OctreeNode*> DAGhash;	// id -> canonical nodes with that id
+	bool isDAG = false;
+	std::vector<LocCode_t> editedLocCodes;	// Nodes changed since the last Recompress(). Only used in a DAG
+
+	uint32_t chunkLevels = 0;	// See TrackChunks(). 0 if not tracking
+	std::unordered_set<LocCode_t> dirtyChunks;	// Chunks (or nodes bigger than a chunk) changed since TakeDirtyChunks()
+
+	/* Mark the chunk of an edited node, and the chunks next to it that it touches */
+	void MarkDirty(LocCode_t LocCode);
+
+	/* GetChunks() below an existing node */
+	void AddChunks(OctreeNode* node, LocCode_t LocCode, std::vector<LocCode_t>& chunks);
+
+	/* The chunks inside the region that lie against a face of the block */
+	void AddBlockChunks(LocCode_t blockLocCode, LocCode_t LocCode, std::vector<LocCode_t>& chunks);
+
+	/* GetVisibleChunks() below the node at the LocCode, for the planes in the mask. Inside a block, the node is that
+	block and blockLocCode its location code, otherwise blockLocCode is 0 */
+	void AddVisibleChunks(OctreeNode* node, LocCode_t LocCode, LocCode_t blockLocCode, const Frustum& frustum,
+		uint8_t planeMask, std::vector<LocCode_t>& chunks, size_t& tested);
+
+	/* GetOccluders() below the node at the LocCode, for the planes in the mask */
+	void AddOccluders(OctreeNode* node, LocCode_t LocCode, const Frustum& frustum, uint8_t planeMask, glm::vec3 eye,
+		float minSize, size_t maxCount, std::vector<glm::vec4>& occluders);
+
+	/* True if the region lies against a face of the block it is in */
+	static bool OnBlockBorder(LocCode_t blockLocCode, LocCode_t LocCode);
+
+	/* The node at the LocCode, or else the block that covers it, found by walking down from the root. The LocCode of
+	the node returned is written to nodeLocCode. A nullptr if there is neither. Works in a DAG */
+	OctreeNode* GetCoveringNode(LocCode_t LocCode, LocCode_t& nodeLocCode);
+
+	/* Same as GetNode, but in a DAG first copies every shared node on the path, so the node can be changed without
+	affecting other locations. The node is remembered, so that Recompress() can share it again */
+	OctreeNode* GetMutableNode(LocCode_t LocCode);
+
+	/* Make child i of the (already unique) node safe to change. Returns the child, which may be a copy */
+	OctreeNode* MakeUnique(OctreeNode* node, uint8_t i);
+
+	/* Re-hash the nodes changed since the last call, deepest first, merging them with identical ones where possible */
+	void Recompress();
+
+	/* Remove a node from the DAGhash, if it is in there */
+	void Unhash(OctreeNode* node);
+
+	/* Updates the visibility of the node and its neighbors. UpdateVisibility without the Recompress() */
+	void CullFaces(LocCode_t LocCode);
+
+	/* Same, for a node that is already at hand. In a DAG, the path to it must be unique (see GetMutableNode) */
+	void CullFaces(OctreeNode* node);
+
+	/* Cull the face of the node, if there is a same-or-larger neighbor on that side. A neighbor of the same size has
+	its face culled as well, and if the node is a block, so do the smaller nodes inside the neighbor that touch it */
+	void CullSharedFace(OctreeNode* node, uint8_t face);
+
+	/* The same-or-larger neighbor of the node on the other side of a face (see UpdateVisibility), or a nullptr
+	Walks up through Parent to the nearest common ancestor of the two, and down from there, so this costs
+	O(levels below the common ancestor) rather than O(depth). The location code of the neighbor is written to
+	neighborLocCode. NOTE: Needs correct Parent pointers on the path, which in a DAG means after GetMutableNode */
+	OctreeNode* GetNeighbor(OctreeNode* node, uint8_t face, LocCode_t& neighborLocCode);
+
+	/* Show the faces of the six neighbors that face the (removed) node at the LocCode again */
+	void ExposeFaces(LocCode_t LocCode);
+
+	/* ExposeFaces() for a removed node and everything inside of it */
+	void ExposeFaces(OctreeNode* node, LocCode_t LocCode);
+
+	/* Show the given face of the neighbor at the LocCode, if there is a neighbor, and of the nodes inside it that touch
+	that face */
+	void ExposeSharedFace(LocCode_t neighborLocCode, uint8_t neighborFace);
+
+	/* Set the given face of every descendant of the node that lies against that face */
+	void UpdateFaceDescendants(OctreeNode* node, LocCode_t LocCode, uint8_t face, bool val);
+
+	/* Called when the block at the LocCode is about to get its first child. The smaller nodes next to it stop counting
+	it as their neighbor, so their faces are shown again */
+	void SplitBlock(LocCode_t LocCode);
+
+	/* True for a leaf without children, i.e. a block that fills the whole node */
+	static bool IsBlock(OctreeNode* node);
+
+	/* Block type to mesh the node with. For a node that is not a block, the type that fills most of it */
+	static uint16_t BlockType(OctreeNode* node);
+
+	/* Calls f(node, LocCode) for every node that CreateMesh() turns into a cube, in the order they are meshed
+	Only the children in the child mask are followed, at every level. That way just one side of the node is visited */
+	template <typename F>
+	void ForEachMeshNode(OctreeNode* node, LocCode_t LocCode, size_t detail, F& f, uint8_t childMask = 255);
+
+	/* CreateMesh() for the binary modes. The detail must already be capped, the neighbor details are capped here */
+	void CreateBinaryMesh(Renderer* renderer, LocCode_t LocCode, size_t detail, bool greedy, MeshScratch& scratch,
+		const size_t* neighborDetail);
+
+	/* Allocate a child of the node, adding it to the index */
+	OctreeNode* CreateChild(OctreeNode* node, uint8_t i);
+
+	/* Add the node and everything inside of it to the index */
+	void IndexNodes(OctreeNode* node);
+
+	/* Recompute the id of the node and all of its ancestors, going up through Parent. Also keeps the rest of their
+	summary up to date, see Summarize() */
+	void UpdateIds(OctreeNode* node);
+
+	/* Recompute the summary of a node from its children: id, type, color, fill and isSolid. The type is the majority
+	of the children's types, weighted by their fill, so it is the true majority only as long as each child's is */
+	static void Summarize(OctreeNode* node);
+
+	/* Replace the children of the node by their canonical version, then return the canonical version of the node itself */
+	OctreeNode* Canonicalize(OctreeNode* node);
+
+	/* True if both nodes hold the same data and point to the same children */
+	static bool IsSameNode(OctreeNode* a, OctreeNode* b);
 
 	/* Update the visibility bitmap
 	Sets the nth bit of it to val */
-	inline void UpdateVisibilityCode(uint8_t &visibility, uint8_t n, bool val);
+	static void UpdateVisibilityCode(uint8_t &visibility, uint8_t n, bool val);
 
 	/* Get the nth bit of the a visibility bitmap */
-	inline bool GetVisibilityCode(uint8_t& visibility, uint8_t n);
+	static bool GetVisibilityCode(uint8_t& visibility, uint8_t n);
 };
+typedef BasicOctree<uint32_t> Octree;
+typedef BasicOctree<uint64_t> Octree64;
+
+// Both are instantiated in Octree.cpp
+extern template class BasicOctree<uint32_t>;
+extern template class BasicOctree<uint64_t>;
+
+template <typename LocCode_t>
+inline uint32_t BasicOctree<LocCode_t>::GetLocDepth(LocCode_t LocCode) {
+	return Morton::HighestBit(LocCode) / 3;	// Overloaded per width
+}
+
+template <typename LocCode_t>
+inline void BasicOctree<LocCode_t>::UpdateVisibilityCode(uint8_t &visibility, uint8_t n, bool val) {
+	visibility ^= (-val ^ visibility) & (1UL << n);
+	
+	// Update at least one face set bit
+	if (visibility & 63UL) {		// This would mean at least one face is set
+		visibility |= (1UL << 6);	// Set "at least one face" to true
+	}
+	else {
+		visibility = (uint8_t)0;
+	}
+
+	// Update at least all faces set bit
+	if ((visibility & 63UL) == 63) {	// This would mean all faces are set
+		visibility = 255;
+		return;
+	}
+	else {
+		visibility &= ~((uint8_t)1 << 7);	// Set "all faces" to false
+	}
+}
+
+template <typename LocCode_t>
+inline bool BasicOctree<LocCode_t>::GetVisibilityCode(uint8_t& visibility, uint8_t n) {
+	return (visibility >> n) & 1U;
+}
+
+template <typename LocCode_t>
+inline glm::u32vec3 BasicOctree<LocCode_t>::LocCodeToPos(LocCode_t LocCode) {
+	size_t depth = GetLocDepth(LocCode);
+	uint32_t x, y, z;
+	Morton::Decode(LocCode ^ ((LocCode_t)1 << (3 * depth)), x, y, z);	// Without the leading 1
+	// Scale up to MAXDEPTH coordinates
+	return glm::u32vec3(x, y, z) * (1U << (BasicOctree::MAXDEPTH - depth));
+}
+
+template <typename LocCode_t>
+inline LocCode_t BasicOctree<LocCode_t>::PosToLocCode(glm::u32vec3 pos, size_t depth) {
+	if (std::max({ pos.x, pos.y, pos.z }) >= (1U << BasicOctree::MAXDEPTH)) {
+		return 0;
+	}
+
+	// Keep the depth most significant bits of each coordinate
+	uint32_t shift = BasicOctree::MAXDEPTH - depth;
+	uint32_t mask = (1U << depth) - 1;
+	return ((LocCode_t)1 << (3 * depth)) | Morton::Encode<LocCode_t>((pos.x >> shift) & mask, (pos.y >> shift) & mask, (pos.z >> shift) & mask);
+}
+
+template <typename LocCode_t>
+inline LocCode_t BasicOctree<LocCode_t>::NeighborLocCode(LocCode_t LocCode, uint8_t face) {
+	// Faces 5 and 4 are x, 3 and 2 are y, 1 and 0 are z. Even faces are on the positive side
+	static const uint64_t axes[3] = { Morton::MASK_Z64, Morton::MASK_Y64, Morton::MASK_X64 };
+	LocCode_t sentinel = (LocCode_t)1 << (3 * GetLocDepth(LocCode));
+	LocCode_t axis = (LocCode_t)axes[face >> 1] & (sentinel - 1);
+	LocCode_t bits = LocCode & axis;
+
+	if (face & 1) {
+		if (bits == 0) {	// Already at the lowest coordinate
+			return 0;
+		}
+		bits = (bits - 1) & axis;	// The borrow skips over the bits of the other axes, as they are masked out
+	}
+	else {
+		if (bits == axis) {		// Already at the highest coordinate
+			return 0;
+		}
+		bits = ((bits | ~axis) + 1) & axis;	// Filling the gaps with ones makes the carry skip over them
+	}
+	return (LocCode & ~axis) | bits;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+/* A minimal benchmark harness, the counterpart of VoxelCubeTests/Test.h
+*
+* BENCHMARK(name) defines a benchmark and registers it with the runner in Main.cpp, which runs them all, or only those
+* whose name contains the first argument. Each benchmark prints its own results. Like the tests, the runner creates a
+* hidden window first for its GL context, and is run from the VoxelCube directory so the shaders are found. Build it in
+* Release, the Debug numbers say little.
+*/
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace Benchmark {
+	typedef void (*BenchmarkFunction)();
+
+	struct BenchmarkCase {
+		const char* name;
+		BenchmarkFunction function;
+	};
+
+	/* Every registered benchmark, in the order the static registrations ran */
+	inline std::vector<BenchmarkCase>& Registry() {
+		static std::vector<BenchmarkCase> benchmarks;
+		return benchmarks;
+	}
+
+	struct Registration {
+		Registration(const char* name, BenchmarkFunction function) { Registry().push_back({ name, function }); }
+	};
+
+	/* Wall clock time since it was made, or last restarted */
+	class Timer {
+	public:
+		Timer() : start(std::chrono::steady_clock::now()) { };
+		void Restart() { start = std::chrono::steady_clock::now(); }
+		double Milliseconds() const {
+			return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+	private:
+		std::chrono::steady_clock::time_point start;
+	};
+
+	/* Keeps a result alive, so the compiler can't drop the work that made it */
+	inline void Consume(uint64_t value) {
+		static volatile uint64_t sink = 0;
+		sink = sink + value;
+	}
+}
+
+#define BENCHMARK(name) \
+	static void name(); \
+	static Benchmark::Registration name##_registration(#name, name); \
+	static void name()
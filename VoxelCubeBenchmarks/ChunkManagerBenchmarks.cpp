@@ -0,0 +1,43 @@
+#include <algorithm>
+#include <cfloat>
+#include <thread>
+#include "Benchmark.h"
+#include "ChunkManager.h"
+
+static const int RUNS = 3;
+
+/* The initial mesh of a random world with 1 to 16 meshing threads, best of RUNS. Nothing is drawn, the time is the
+meshing plus the upload into the mesh buffer on the calling thread. Every thread count must give the same faces
+The world is the game's random world one level finer, so that there is enough to mesh to spread over 16 threads */
+BENCHMARK(ChunkMeshingThreads) {
+	Octree world = Octree();
+	Renderer renderer;
+	world.InsertRandomNodes(&renderer, 7);
+	world.CompressToDAG();
+	glm::vec3 viewer = glm::vec3(-1.0f, -1.0f, -1.0f);	// Where the game's camera starts
+	std::cout << "  " << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+
+	double single = 0.0;
+	size_t faces = 0;
+	for (unsigned int threads : { 1U, 2U, 4U, 8U, 16U }) {
+		double best = DBL_MAX;
+		size_t meshed = 0;
+		bool same = true;
+		for (int run = 0; run < RUNS; run++) {
+			ChunkManager manager(&world, threads);
+			Benchmark::Timer timer;
+			meshed = manager.Update(viewer);
+			best = std::min(best, timer.Milliseconds());
+			if (faces == 0) {
+				faces = manager.FaceCount();
+			}
+			same = same && manager.FaceCount() == faces;
+			manager.UnbindMeshes();
+		}
+		if (threads == 1) {
+			single = best;
+		}
+		std::cout << "  " << threads << " threads: " << meshed << " chunks, " << faces << " faces in " << best
+			<< " ms, " << single / best << "x" << (same ? "" : " (faces differ)") << std::endl;
+	}
+}
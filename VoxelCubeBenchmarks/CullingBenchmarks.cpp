@@ -0,0 +1,84 @@
+#include <cmath>
+#include <functional>
+#include "Benchmark.h"
+#include "ChunkManager.h"
+
+static const int FRAMES = 120;
+static const unsigned int WIDTH = 800;
+static const unsigned int HEIGHT = 600;
+
+/* A camera at the position, looking at the target */
+static Camera LookAt(glm::vec3 position, glm::vec3 target) {
+	glm::vec3 direction = glm::normalize(target - position);
+	float yaw = glm::degrees(std::atan2(direction.z, direction.x));
+	float pitch = glm::degrees(std::asin(direction.y));
+	return Camera(position, glm::vec3(0.0f, 1.0f, 0.0f), yaw, pitch);
+}
+
+/* The camera paths, as the camera at frame i of FRAMES */
+static Camera Orbit(int frame) {
+	float angle = 6.2831853f * frame / FRAMES;
+	glm::vec3 center = glm::vec3(512.0f);
+	return LookAt(center + glm::vec3(1400.0f * std::cos(angle), 700.0f, 1400.0f * std::sin(angle)), center);
+}
+
+static Camera LookAround(int frame) {
+	float t = (float)frame / FRAMES;
+	return Camera(glm::vec3(512.0f, 300.0f, 512.0f), glm::vec3(0.0f, 1.0f, 0.0f), 360.0f * t, 40.0f * std::sin(12.566f * t));
+}
+
+static Camera FlyThrough(int frame) {
+	glm::vec3 start = glm::vec3(-100.0f, 200.0f, -100.0f);
+	glm::vec3 end = glm::vec3(1100.0f, 600.0f, 1100.0f);
+	return LookAt(start + (end - start) * ((float)frame / FRAMES), end);
+}
+
+/* Render the world along the path, and print per frame on average: the octree boxes tested against the frustum, the
+chunks drawn and the chunks hidden behind others, the time of the walk down the octree alone, and of all of Render().
+The viewer moves, so the LODs are updated every frame, but that isn't timed */
+static void RunPath(const char* name, Octree& world, ChunkManager& manager, const std::function<Camera(int)>& path) {
+	size_t tested = 0, drawn = 0, occluded = 0;
+	double walk = 0.0, render = 0.0;
+	std::vector<uint32_t> visible;
+	for (int frame = 0; frame < FRAMES; frame++) {
+		Camera camera = path(frame);
+		manager.Update(camera.Position);
+
+		Frustum frustum(Renderer::ProjectionMatrix(camera, WIDTH, HEIGHT) * camera.GetViewMatrix());
+		visible.clear();
+		Benchmark::Timer timer;
+		world.GetVisibleChunks(frustum, visible);
+		walk += timer.Milliseconds();
+
+		timer.Restart();
+		manager.Render(camera, WIDTH, HEIGHT);
+		render += timer.Milliseconds();
+		glFinish();
+		tested += manager.BoxesTested();
+		drawn += manager.ChunksDrawn();
+		occluded += manager.ChunksOccluded();
+	}
+	std::cout << "  " << name << ": " << tested / FRAMES << " boxes tested, " << drawn / FRAMES << " chunks drawn, "
+		<< occluded / FRAMES << " occluded, walk " << walk * 1000.0 / FRAMES << " us, render " << render * 1000.0 / FRAMES
+		<< " us" << std::endl;
+}
+
+/* The game's random world, seen from outside, from inside and flying through it, as a tree and as a DAG */
+BENCHMARK(CullingCameraPaths) {
+	for (bool dag : { false, true }) {
+		Octree world = Octree();
+		Renderer renderer;
+		world.InsertRandomNodes(&renderer, 6);
+		if (dag) {
+			world.CompressToDAG();
+		}
+		ChunkManager manager(&world);
+		manager.Update(Orbit(0).Position);
+		std::cout << " " << (dag ? "DAG" : "Tree") << ", " << manager.ChunkCount() << " chunks" << std::endl;
+
+		RunPath("orbit outside", world, manager, Orbit);
+		RunPath("inside, looking around", world, manager, LookAround);
+		RunPath("fly-through", world, manager, FlyThrough);
+		manager.UnbindMeshes();
+	}
+}
@@ -0,0 +1,48 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <cstring>
+#include <iostream>
+#include "Benchmark.h"
+
+int main(int argc, char** argv) {
+    // Hidden window, only for its GL context. Same version as the game asks for
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    #ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    #endif
+
+    GLFWwindow* window = glfwCreateWindow(64, 64, "VoxelCubeBenchmarks", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+
+    // Only the benchmarks whose name contains the first argument, if there is one
+    const char* filter = argc > 1 ? argv[1] : "";
+    for (const Benchmark::BenchmarkCase& benchmark : Benchmark::Registry())
+    {
+        if (std::strstr(benchmark.name, filter) == NULL)
+        {
+            continue;
+        }
+        std::cout << "== " << benchmark.name << std::endl;
+        benchmark.function();
+    }
+
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <cfloat>
+#include <random>
+#include "Benchmark.h"
+#include "World/Morton.h"
+#include "World/Octree.h"
+
+static const size_t COUNT = 1 << 22;
+static const int RUNS = 5;
+
+/* Random coordinates of the given number of bits */
+static std::vector<glm::u32vec3> RandomCoordinates(uint32_t bits) {
+	std::mt19937 random(7);
+	std::vector<glm::u32vec3> coordinates(COUNT);
+	uint32_t mask = (1U << bits) - 1;
+	for (glm::u32vec3& c : coordinates) {
+		c = glm::u32vec3(random() & mask, random() & mask, random() & mask);
+	}
+	return coordinates;
+}
+
+/* Best of RUNS passes of f over every input, printed as millions of inputs per second */
+template <typename T, typename F>
+static void Time(const char* kernel, const std::vector<T>& inputs, F f) {
+	double best = DBL_MAX;
+	uint64_t sum = 0;
+	for (int run = 0; run < RUNS; run++) {
+		Benchmark::Timer timer;
+		for (const T& input : inputs) {
+			sum += f(input);
+		}
+		best = std::min(best, timer.Milliseconds());
+	}
+	Benchmark::Consume(sum);
+	std::cout << "  " << kernel << ": " << COUNT / best / 1000.0 << " M/s" << std::endl;
+}
+
+/* Interleaving one bit at a time, as before the kernels */
+template <typename T>
+static T LoopEncode(uint32_t x, uint32_t y, uint32_t z, uint32_t bits) {
+	T code = 0;
+	for (uint32_t i = 0; i < bits; i++) {
+		code |= (T)((x >> i) & 1) << (3 * i + 2) | (T)((y >> i) & 1) << (3 * i + 1) | (T)((z >> i) & 1) << (3 * i);
+	}
+	return code;
+}
+
+template <typename T>
+static glm::u32vec3 LoopDecode(T code, uint32_t bits) {
+	glm::u32vec3 c(0);
+	for (uint32_t i = 0; i < bits; i++) {
+		c.x |= (uint32_t)((code >> (3 * i + 2)) & 1) << i;
+		c.y |= (uint32_t)((code >> (3 * i + 1)) & 1) << i;
+		c.z |= (uint32_t)((code >> (3 * i)) & 1) << i;
+	}
+	return c;
+}
+
+/* Encode and decode of 30-bit codes: one bit at a time, the magic number fallback, pdep/pext, and the Octree functions
+with the kernel the build picked. The BMI2 kernels only run in a build with BMI2 (see Morton.h) */
+BENCHMARK(MortonKernels32) {
+	std::vector<glm::u32vec3> coordinates = RandomCoordinates(10);
+	std::cout << " Encode" << std::endl;
+	Time("loop", coordinates, [](glm::u32vec3 c) { return LoopEncode<uint32_t>(c.x, c.y, c.z, 10); });
+	Time("magic numbers", coordinates, [](glm::u32vec3 c) {
+		return (Morton::Spread(c.x) << 2) | (Morton::Spread(c.y) << 1) | Morton::Spread(c.z);
+	});
+#if MORTON_USE_BMI2
+	Time("pdep", coordinates, [](glm::u32vec3 c) {
+		return _pdep_u32(c.x, Morton::MASK_X) | _pdep_u32(c.y, Morton::MASK_Y) | _pdep_u32(c.z, Morton::MASK_Z);
+	});
+#endif
+	Time("PosToLocCode", coordinates, [](glm::u32vec3 c) { return Octree::PosToLocCode(c, 10); });
+
+	std::cout << " Decode" << std::endl;
+	std::vector<uint32_t> codes(COUNT);
+	for (size_t i = 0; i < COUNT; i++) {
+		codes[i] = (1U << 30) | Morton::Encode<uint32_t>(coordinates[i].x, coordinates[i].y, coordinates[i].z);
+	}
+	Time("loop", codes, [](uint32_t code) {
+		glm::u32vec3 p = LoopDecode<uint32_t>(code, 10);
+		return p.x + p.y + p.z;
+	});
+	Time("magic numbers", codes, [](uint32_t code) {
+		return Morton::Compact(code >> 2) + Morton::Compact(code >> 1) + Morton::Compact(code);
+	});
+#if MORTON_USE_BMI2
+	Time("pext", codes, [](uint32_t code) {
+		return _pext_u32(code, Morton::MASK_X) + _pext_u32(code, Morton::MASK_Y) + _pext_u32(code, Morton::MASK_Z);
+	});
+#endif
+	Time("LocCodeToPos", codes, [](uint32_t code) {
+		glm::u32vec3 p = Octree::LocCodeToPos(code);
+		return p.x + p.y + p.z;
+	});
+}
+
+/* The same for the 63-bit codes of Octree64 */
+BENCHMARK(MortonKernels64) {
+	std::vector<glm::u32vec3> coordinates = RandomCoordinates(21);
+	std::cout << " Encode" << std::endl;
+	Time("loop", coordinates, [](glm::u32vec3 c) { return LoopEncode<uint64_t>(c.x, c.y, c.z, 21); });
+	Time("magic numbers", coordinates, [](glm::u32vec3 c) {
+		return (Morton::Spread64(c.x) << 2) | (Morton::Spread64(c.y) << 1) | Morton::Spread64(c.z);
+	});
+#if MORTON_USE_BMI2_64
+	Time("pdep", coordinates, [](glm::u32vec3 c) {
+		return _pdep_u64(c.x, Morton::MASK_X64) | _pdep_u64(c.y, Morton::MASK_Y64) | _pdep_u64(c.z, Morton::MASK_Z64);
+	});
+#endif
+	Time("PosToLocCode", coordinates, [](glm::u32vec3 c) { return Octree64::PosToLocCode(c, 21); });
+
+	std::cout << " Decode" << std::endl;
+	std::vector<uint64_t> codes(COUNT);
+	for (size_t i = 0; i < COUNT; i++) {
+		codes[i] = ((uint64_t)1 << 63) | Morton::Encode<uint64_t>(coordinates[i].x, coordinates[i].y, coordinates[i].z);
+	}
+	Time("loop", codes, [](uint64_t code) {
+		glm::u32vec3 p = LoopDecode<uint64_t>(code, 21);
+		return p.x + p.y + p.z;
+	});
+	Time("magic numbers", codes, [](uint64_t code) {
+		return Morton::Compact64(code >> 2) + Morton::Compact64(code >> 1) + Morton::Compact64(code);
+	});
+#if MORTON_USE_BMI2_64
+	Time("pext", codes, [](uint64_t code) {
+		return _pext_u64(code, Morton::MASK_X64) + _pext_u64(code, Morton::MASK_Y64) + _pext_u64(code, Morton::MASK_Z64);
+	});
+#endif
+	Time("LocCodeToPos", codes, [](uint64_t code) {
+		glm::u32vec3 p = Octree64::LocCodeToPos(code);
+		return p.x + p.y + p.z;
+	});
+}
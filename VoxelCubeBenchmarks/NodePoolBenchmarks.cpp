@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <cfloat>
+#include "Benchmark.h"
+#include "World/NodePool.h"
+#include "World/Octree.h"
+
+static const int RUNS = 5;
+
+/* Copy of the subtree, with every node from allocate(parent, LocCode) */
+template <typename Allocate>
+static OctreeNode* CopyTree(OctreeNode* node, OctreeNode* parent, Allocate& allocate) {
+	OctreeNode* copy = allocate(parent, node->LocCode);
+	copy->id = node->id;
+	copy->color = node->color;
+	copy->isLeaf = node->isLeaf;
+	for (int i = 0; i < 8; i++) {
+		if (node->Children[i] != nullptr) {
+			copy->Children[i] = CopyTree(node->Children[i], copy, allocate);
+		}
+	}
+	return copy;
+}
+
+/* Teardown before the pool: one delete per node, children first */
+static void DeleteTree(OctreeNode* node) {
+	for (int i = 0; i < 8; i++) {
+		if (node->Children[i] != nullptr) {
+			DeleteTree(node->Children[i]);
+		}
+	}
+	delete node;
+}
+
+/* Building and dropping the depth 6 random world of the game, which is all pooled now */
+BENCHMARK(OctreeInsertTeardown) {
+	double insert = DBL_MAX, teardown = DBL_MAX;
+	size_t nodes = 0;
+	for (int run = 0; run < RUNS; run++) {
+		Octree* tree = new Octree();
+		Renderer renderer;
+		Benchmark::Timer timer;
+		tree->InsertRandomNodes(&renderer, 6);
+		insert = std::min(insert, timer.Milliseconds());
+		nodes = tree->NodeCount();
+
+		timer.Restart();
+		delete tree;
+		teardown = std::min(teardown, timer.Milliseconds());
+	}
+	std::cout << "  " << nodes << " nodes: insert " << insert << " ms, teardown " << teardown << " ms" << std::endl;
+}
+
+/* The same tree built node by node with new and freed with one delete per node, as before the pool, against building
+it from a NodePool and dropping its blocks. Only the allocation differs, so this is the part the pool changed */
+BENCHMARK(NodePoolAgainstNewDelete) {
+	Octree tree = Octree();
+	Renderer renderer;
+	tree.InsertRandomNodes(&renderer, 6);
+	OctreeNode* root = tree.GetNode(1);
+
+	double heapInsert = DBL_MAX, heapTeardown = DBL_MAX, poolInsert = DBL_MAX, poolTeardown = DBL_MAX;
+	for (int run = 0; run < RUNS; run++) {
+		auto allocateHeap = [](OctreeNode* parent, uint32_t LocCode) { return new OctreeNode(parent, LocCode); };
+		Benchmark::Timer timer;
+		OctreeNode* heapRoot = CopyTree(root, nullptr, allocateHeap);
+		heapInsert = std::min(heapInsert, timer.Milliseconds());
+		timer.Restart();
+		DeleteTree(heapRoot);
+		heapTeardown = std::min(heapTeardown, timer.Milliseconds());
+
+		NodePool<OctreeNode> pool;
+		auto allocatePool = [&pool](OctreeNode* parent, uint32_t LocCode) { return pool.Allocate(parent, LocCode); };
+		timer.Restart();
+		OctreeNode* poolRoot = CopyTree(root, nullptr, allocatePool);
+		poolInsert = std::min(poolInsert, timer.Milliseconds());
+		Benchmark::Consume(poolRoot->id);
+		timer.Restart();
+		pool.Clear();
+		poolTeardown = std::min(poolTeardown, timer.Milliseconds());
+	}
+	std::cout << "  " << tree.NodeCount() << " nodes" << std::endl;
+	std::cout << "  new/delete: insert " << heapInsert << " ms, teardown " << heapTeardown << " ms" << std::endl;
+	std::cout << "  NodePool:   insert " << poolInsert << " ms, teardown " << poolTeardown << " ms" << std::endl;
+}
@@ -0,0 +1,349 @@
+#include <algorithm>
+#include <random>
+#include <set>
+#include <tuple>
+#include <unordered_set>
+#include "Test.h"
+#include "ChunkManager.h"
+
+/* Ground with hills, over several chunks in each direction */
+static void InsertHills(Octree& world) {
+	std::vector<VoxelInsert> voxels;
+	for (uint32_t x = 0; x < 128; x++) {
+		for (uint32_t z = 0; z < 128; z++) {
+			uint32_t height = 8 + (x * x + z * 3) % 11;
+			for (uint32_t y = 0; y < height; y++) {
+				voxels.push_back({ Octree::PosToLocCode(glm::u32vec3(x, y, z), 10), glm::vec4(1.0f), (uint16_t)(1 + y % 2) });
+			}
+		}
+	}
+	world.InsertBatch(voxels);
+}
+
+static const uint32_t RINGS_SIZE = 512;	// Width of the InsertRings() ground. It is 32 high
+
+/* Index of a unit of the InsertRings() ground */
+static size_t RingsUnit(uint32_t x, uint32_t y, uint32_t z) {
+	return x + RINGS_SIZE * (y + 32 * (size_t)z);
+}
+
+/* Ground of 512x512, far enough from a viewer near the origin to span the LOD rings up to LOD 3. It is made of 8^3
+blocks, 1 to 3 high, with single blocks scattered above it so the LODs have detail to drop. It all lies in the lowest
+layer of chunks. If solid is given, it is set to the units the world fills, indexed by RingsUnit() */
+static void InsertRings(Octree& world, std::vector<uint8_t>* solid = nullptr) {
+	if (solid != nullptr) {
+		solid->assign(RINGS_SIZE * 32 * RINGS_SIZE, 0);
+	}
+	std::mt19937 random(21);
+	for (uint32_t x = 0; x < RINGS_SIZE; x += 8) {
+		for (uint32_t z = 0; z < RINGS_SIZE; z += 8) {
+			uint32_t height = 1 + (x * 3 + z * 5) / 8 % 3;
+			for (uint32_t y = 0; y < height; y++) {
+				world.InsertNode(Octree::PosToLocCode(glm::u32vec3(x, 8 * y, z), 7), glm::vec4(1.0f), 1);
+			}
+			for (uint32_t i = 0; solid != nullptr && i < 8 * 8 * 8 * height; i++) {
+				(*solid)[RingsUnit(x + i % 8, i / 64, z + i / 8 % 8)] = 1;
+			}
+		}
+	}
+	for (int i = 0; i < 6000; i++) {
+		glm::u32vec3 pos = glm::u32vec3(random() % RINGS_SIZE, 24 + random() % 8, random() % RINGS_SIZE);
+		world.InsertNode(Octree::PosToLocCode(pos, 10), glm::vec4(1.0f), 2);
+		if (solid != nullptr) {
+			(*solid)[RingsUnit(pos.x, pos.y, pos.z)] = 1;
+		}
+	}
+}
+
+/* The LOD of a chunk for a viewer, as ChunkManager works it out: one more LOD for every doubling of the distance to
+the chunk past minDistance */
+static uint8_t Ring(uint32_t chunk, glm::vec3 viewer) {
+	glm::vec3 pos = glm::vec3(Octree::LocCodeToPos(chunk));
+	glm::vec3 end = pos + glm::vec3((float)(1U << ChunkManager::ChunkDepth));
+	float distance = glm::length(glm::max(glm::max(pos - viewer, viewer - end), glm::vec3(0.0f)));
+	uint8_t lod = 0;
+	for (float ring = (float)ChunkManager::minDistance; distance >= ring && lod < ChunkManager::ChunkDepth; ring *= 2) {
+		lod++;
+	}
+	return lod;
+}
+
+/* The same random edit on both worlds: a block, a bigger node, a removal, or a small batch */
+static void RandomEdit(std::mt19937& random, Octree& a, Octree& b) {
+	glm::u32vec3 pos = glm::u32vec3(random() % 128, random() % 24, random() % 128);
+	uint32_t depth = 10 - (random() % 6 == 0 ? 2 : 0);
+	uint32_t code = Octree::PosToLocCode(pos, depth);
+	switch (random() % 4) {
+	case 0:
+	case 1:
+		a.InsertNode(code, glm::vec4(1.0f), 3);
+		b.InsertNode(code, glm::vec4(1.0f), 3);
+		break;
+	case 2:
+		a.RemoveNode(code);
+		b.RemoveNode(code);
+		break;
+	default: {
+		std::vector<VoxelInsert> batch;
+		for (uint32_t i = 0; i < 5; i++) {
+			batch.push_back({ Octree::PosToLocCode(glm::u32vec3(pos.x, pos.y + i, pos.z), 10), glm::vec4(1.0f), 2 });
+		}
+		std::vector<VoxelInsert> copy = batch;
+		a.InsertBatch(batch);
+		b.InsertBatch(copy);
+	}
+	}
+}
+
+/* Re-meshing only the dirty chunks ends up with the same chunks and faces as meshing everything from scratch, on a
+tree and on a DAG. A single block edit re-meshes at most the chunk and its neighbors */
+TEST(ChunkManagerIncrementalMatchesFresh) {
+	for (bool dag : { false, true }) {
+		Octree world = Octree();
+		Octree copy = Octree();
+		InsertHills(world);
+		InsertHills(copy);
+		if (dag) {
+			world.CompressToDAG();
+			copy.CompressToDAG();
+		}
+		glm::vec3 viewer = glm::vec3(64.0f, 30.0f, 64.0f);
+
+		ChunkManager incremental(&world, 1);
+		incremental.Update(viewer);
+		std::mt19937 random(13);
+		for (int round = 1; round <= 60; round++) {
+			RandomEdit(random, world, copy);
+			incremental.Update(viewer);
+
+			if (round % 20 == 0) {
+				ChunkManager fresh(&copy, 1);
+				fresh.Update(viewer);
+				CHECK(incremental.ChunkCount() == fresh.ChunkCount());
+				CHECK(incremental.FaceCount() == fresh.FaceCount());
+				fresh.UnbindMeshes();
+			}
+		}
+
+		uint32_t block = Octree::PosToLocCode(glm::u32vec3(40, 30, 40), 10);	// Above the hills, inside a chunk
+		world.InsertNode(block, glm::vec4(1.0f));
+		CHECK(incremental.Update(viewer) == 1);
+		incremental.UnbindMeshes();
+	}
+}
+
+/* Meshing on the worker pool gives the same chunks and faces as meshing on the calling thread alone */
+TEST(ChunkManagerThreadsMatchSingleThread) {
+	Octree world = Octree();
+	Octree copy = Octree();
+	InsertHills(world);
+	InsertHills(copy);
+	glm::vec3 viewer = glm::vec3(20.0f, 30.0f, 100.0f);
+
+	ChunkManager single(&world, 1);
+	ChunkManager threaded(&copy, 4);
+	CHECK(single.Update(viewer) == threaded.Update(viewer));
+	std::mt19937 random(14);
+	for (int round = 0; round < 20; round++) {
+		for (int i = 0; i < 10; i++) {
+			RandomEdit(random, world, copy);
+		}
+		CHECK(single.Update(viewer) == threaded.Update(viewer));
+		CHECK(single.ChunkCount() == threaded.ChunkCount());
+		CHECK(single.FaceCount() == threaded.FaceCount());
+	}
+	single.UnbindMeshes();
+	threaded.UnbindMeshes();
+}
+
+/* A viewer moving across the LOD rings, in steps bigger than LodMoveDistance. After every step the chunks and faces
+are those of a fresh mesh at the same place, and only the chunks whose ring changed were re-meshed, with their
+neighbors. A step shorter than LodMoveDistance re-meshes nothing */
+TEST(ChunkManagerLodFollowsViewer) {
+	Octree world = Octree();
+	Octree copy = Octree();
+	InsertRings(world);
+	InsertRings(copy);
+	glm::vec3 viewer = glm::vec3(0.0f, 20.0f, 0.0f);
+	ChunkManager manager(&world, 2);
+	manager.Update(viewer);
+	std::vector<uint32_t> all;
+	world.GetChunks(1, all);
+	std::unordered_set<uint32_t> chunkSet(all.begin(), all.end());
+	CHECK(all.size() == manager.ChunkCount());
+	std::set<uint8_t> lods;
+	for (uint32_t chunk : all) {
+		lods.insert(Ring(chunk, viewer));
+	}
+	CHECK(lods.size() == 4);	// LOD 0 to 3
+
+	size_t remeshed = 0;
+	for (int step = 1; step <= 24; step++) {
+		glm::vec3 next = glm::vec3(29.0f * step, 20.0f + (step % 3) * 10.0f, 23.0f * step);
+		std::set<uint32_t> changed, bound;
+		for (uint32_t chunk : all) {
+			if (Ring(chunk, next) != Ring(chunk, viewer)) {
+				changed.insert(chunk);
+				bound.insert(chunk);
+				for (uint8_t face = 0; face < 6; face++) {
+					uint32_t neighbor = Octree::NeighborLocCode(chunk, face);
+					if (chunkSet.count(neighbor) > 0) {
+						bound.insert(neighbor);
+					}
+				}
+			}
+		}
+		viewer = next;
+		size_t meshed = manager.Update(viewer);
+		CHECK(meshed >= changed.size());
+		CHECK(meshed <= bound.size());
+		CHECK(meshed < all.size());
+		remeshed += meshed;
+
+		ChunkManager fresh(&copy, 1);
+		fresh.Update(viewer);
+		CHECK(manager.ChunkCount() == fresh.ChunkCount());
+		CHECK(manager.FaceCount() == fresh.FaceCount());
+		fresh.UnbindMeshes();
+
+		CHECK(manager.Update(viewer + glm::vec3(ChunkManager::LodMoveDistance * 0.5f, 0.0f, 0.0f)) == 0);
+	}
+	CHECK(remeshed > 0);
+	CHECK(remeshed < 24 * all.size() / 2);	// Far from re-meshing the world every step
+	manager.UnbindMeshes();
+}
+
+/* A viewer among the LOD rings, and every border face of every chunk checked against the occupancy of the world. A
+border face of a chunk is drawn exactly where its cube isn't covered by the cubes its neighbor draws at its own LOD:
+so there are no cracks where the LOD changes, and no faces hidden by a coarser neighbor are drawn */
+TEST(ChunkManagerLodBordersHaveNoCracks) {
+	Octree world = Octree();
+	std::vector<uint8_t> solid;
+	InsertRings(world, &solid);
+
+	// pyramid[l] holds, for every cell of 2^l units, whether any of its units is solid
+	std::vector<std::vector<uint8_t>> pyramid(ChunkManager::ChunkDepth + 1);
+	pyramid[0] = solid;
+	for (uint32_t level = 1; level <= ChunkManager::ChunkDepth; level++) {
+		uint32_t width = RINGS_SIZE >> level, height = 32 >> level;
+		pyramid[level].assign(width * height * width, 0);
+		for (uint32_t i = 0; i < pyramid[level].size(); i++) {
+			uint32_t x = i % width, y = i / width % height, z = i / width / height;
+			for (uint8_t child = 0; child < 8; child++) {
+				uint32_t cx = 2 * x + (child & 1), cy = 2 * y + (child >> 1 & 1), cz = 2 * z + (child >> 2);
+				pyramid[level][i] |= pyramid[level - 1][cx + 2 * width * (cy + 2 * height * cz)];
+			}
+		}
+	}
+	auto filled = [&](uint8_t level, glm::ivec3 unit) {
+		if (unit.x < 0 || unit.y < 0 || unit.z < 0 || unit.x >= (int32_t)RINGS_SIZE || unit.y >= 32 || unit.z >= (int32_t)RINGS_SIZE) {
+			return false;
+		}
+		uint32_t x = unit.x >> level, y = unit.y >> level, z = unit.z >> level;
+		return pyramid[level][x + (RINGS_SIZE >> level) * (y + (32 >> level) * z)] != 0;
+	};
+
+	glm::vec3 viewer = glm::vec3(0.0f, 20.0f, 0.0f);
+	ChunkManager manager(&world, 2);
+	manager.Update(viewer);
+
+	typedef std::tuple<uint8_t, int32_t, int32_t, int32_t> CellFace;	// Face, and the cell in mesh units
+	std::set<uint8_t> lods;
+	size_t borderFaces = 0, keptAgainstFiner = 0, hiddenByCoarser = 0;
+	for (uint32_t x = 0; x < RINGS_SIZE; x += 32) {
+		for (uint32_t z = 0; z < RINGS_SIZE; z += 32) {
+			uint32_t chunk = Octree::PosToLocCode(glm::u32vec3(x, 0, z), ChunkManager::ChunkDepth);
+			Renderer* mesh = manager.GetChunkMesh(chunk);
+			CHECK(mesh != nullptr);
+			if (mesh == nullptr) {
+				continue;
+			}
+			uint8_t lod = Ring(chunk, viewer);
+			int32_t unit = 1 << lod;
+			int32_t cells = 32 / unit;
+			glm::ivec3 origin = glm::ivec3(x, 0, z);
+			CHECK(mesh->GetMeshUnit() == (uint32_t)unit);
+			CHECK(glm::ivec3(mesh->GetMeshOrigin()) == origin);
+			lods.insert(lod);
+
+			// The faces of the mesh on the border of the chunk, with quads cut up into cells
+			std::set<CellFace> meshed;
+			for (size_t i = 0; i + 3 < mesh->vertexArray.size(); i += 4) {
+				int32_t low[3] = { INT32_MAX, INT32_MAX, INT32_MAX };
+				int32_t high[3] = { 0, 0, 0 };
+				uint8_t face;
+				uint16_t type;
+				for (size_t v = 0; v < 4; v++) {
+					uint32_t pos[3];
+					Renderer::UnpackVertex(mesh->vertexArray[i + v], pos[0], pos[1], pos[2], face, type);
+					for (int axis = 0; axis < 3; axis++) {
+						low[axis] = std::min(low[axis], (int32_t)pos[axis]);
+						high[axis] = std::max(high[axis], (int32_t)pos[axis]);
+					}
+				}
+				uint8_t axis = face / 2;
+				low[axis] -= face & 1;	// From the plane of the quad to its cell
+				if (low[axis] != ((face & 1) ? cells - 1 : 0)) {
+					continue;
+				}
+				high[axis] = low[axis] + 1;
+				for (int32_t cx = low[0]; cx < high[0]; cx++) {
+					for (int32_t cy = low[1]; cy < high[1]; cy++) {
+						for (int32_t cz = low[2]; cz < high[2]; cz++) {
+							meshed.insert(CellFace(face, cx, cy, cz));
+						}
+					}
+				}
+			}
+
+			// A filled border cell has its face drawn unless every unit of it is covered by a cube of the neighbor.
+			// Faces are numbered as in PackVertex() here, not as in NeighborLocCode()
+			std::set<CellFace> expected;
+			for (uint8_t face = 0; face < 6; face++) {
+				uint8_t axis = face / 2, u = (axis + 1) % 3, v = (axis + 2) % 3;
+				glm::ivec3 neighborPos = origin;
+				neighborPos[axis] += (face & 1) ? 32 : -32;
+				uint32_t neighbor = 0;
+				if (neighborPos[axis] >= 0 && neighborPos[axis] < 1024) {
+					neighbor = Octree::PosToLocCode(glm::u32vec3(neighborPos), ChunkManager::ChunkDepth);
+				}
+				uint8_t neighborLod = neighbor == 0 ? lod : Ring(neighbor, viewer);
+				int32_t step = std::min(unit, 1 << neighborLod);
+				for (int32_t i = 0; i < cells; i++) {
+					for (int32_t j = 0; j < cells; j++) {
+						glm::ivec3 cell;
+						cell[axis] = (face & 1) ? cells - 1 : 0;
+						cell[u] = i;
+						cell[v] = j;
+						if (!filled(lod, origin + cell * unit)) {
+							continue;
+						}
+						size_t parts = 0, covered = 0;
+						for (int32_t du = 0; du < unit; du += step) {
+							for (int32_t dv = 0; dv < unit; dv += step) {
+								glm::ivec3 across = origin + cell * unit;
+								across[axis] += (face & 1) ? unit : -1;
+								across[u] += du;
+								across[v] += dv;
+								parts++;
+								covered += neighbor != 0 && filled(neighborLod, across);
+							}
+						}
+						if (covered < parts) {
+							expected.insert(CellFace(face, cell.x, cell.y, cell.z));
+						}
+						keptAgainstFiner += neighborLod < lod && covered > 0 && covered < parts;
+						hiddenByCoarser += neighborLod > lod && covered == parts;
+					}
+				}
+			}
+			CHECK(meshed == expected);
+			borderFaces += expected.size();
+		}
+	}
+	CHECK(lods.size() == 4);	// LOD 0 to 3
+	CHECK(borderFaces > 0);
+	CHECK(keptAgainstFiner > 0);
+	CHECK(hiddenByCoarser > 0);
+	manager.UnbindMeshes();
+}
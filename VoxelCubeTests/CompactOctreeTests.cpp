@@ -0,0 +1,87 @@
+#include <random>
+#include "Test.h"
+#include "World/CompactOctree.h"
+#include "World/Octree.h"
+
+/* The vertices with their block type cleared. CompactOctree keeps no summaries (see Octree::Summarize), so a node
+that is cut off by the level of detail is meshed with type 0 rather than the type that fills most of it */
+static std::vector<uint32_t> MeshGeometry(const Renderer& renderer) {
+	std::vector<uint32_t> geometry;
+	for (uint32_t vertex : renderer.vertexArray) {
+		uint32_t x, y, z;
+		uint8_t face;
+		uint16_t type;
+		Renderer::UnpackVertex(vertex, x, y, z, face, type);
+		geometry.push_back(Renderer::PackVertex(x, y, z, face, 0));
+	}
+	return geometry;
+}
+
+/* The random worlds of both trees have the same shape, so they give the same faces at every level of detail */
+TEST(CompactOctreeRandomMesh) {
+	for (size_t depth : { 3, 5, 6 }) {
+		Octree tree = Octree();
+		CompactOctree compact = CompactOctree();
+		tree.InsertRandomNodes(nullptr, depth);
+		compact.InsertRandomNodes(nullptr, depth);
+		CHECK(compact.NodeCount() == tree.NodeCount());
+
+		for (size_t detail : { 2, 4, 6 }) {
+			Renderer treeMesh, compactMesh;
+			tree.CreateMesh(&treeMesh, 1, detail);
+			compact.CreateMesh(&compactMesh, 1, detail);
+			CHECK(!treeMesh.vertexArray.empty());
+			CHECK(MeshGeometry(compactMesh) == MeshGeometry(treeMesh));
+		}
+	}
+}
+
+/* Blocks inserted one by one, in random order and with random types. Both trees find the same nodes, with the same
+block type and culled faces, and mesh them the same */
+TEST(CompactOctreeInsertNode) {
+	Octree tree = Octree();
+	CompactOctree compact = CompactOctree();
+	std::mt19937 random(3);
+	std::vector<uint32_t> codes;
+	for (int i = 0; i < 3000; i++) {
+		uint32_t code = Octree::PosToLocCode(glm::u32vec3(random() % 32, random() % 32, random() % 32), 10);
+		uint16_t id = 1 + random() % 7;
+		tree.InsertNode(code, glm::vec4(1.0f), id);
+		compact.InsertNode(code, glm::vec4(1.0f), id);
+		codes.push_back(code);
+	}
+	CHECK(compact.NodeCount() == tree.NodeCount());
+
+	for (uint32_t code : codes) {
+		OctreeNode* node = tree.GetNode(code);
+		CompactNode* compactNode = compact.GetNode(code);
+		CHECK(compactNode != nullptr);
+		if (compactNode != nullptr) {
+			CHECK(compactNode->id == node->id);
+			CHECK(compactNode->visibility == node->visibility);
+		}
+	}
+	// Nodes that don't exist, on a path that does and one that doesn't
+	CHECK(compact.GetNode(Octree::PosToLocCode(glm::u32vec3(100, 0, 0), 10)) == nullptr);
+	CHECK(compact.GetNode(Octree::PosToLocCode(glm::u32vec3(600, 600, 600), 10)) == nullptr);
+	CHECK(compact.GetNode(0) == nullptr);
+
+	uint32_t chunk = Octree::PosToLocCode(glm::u32vec3(0), 5);
+	Renderer treeMesh, compactMesh;
+	tree.CreateMesh(&treeMesh, chunk, 5);
+	compact.CreateMesh(&compactMesh, chunk, 5);
+	CHECK(compactMesh.vertexArray == treeMesh.vertexArray);
+
+	// Meshing where there is no node adds nothing, like Octree
+	Renderer empty;
+	compact.CreateMesh(&empty, Octree::PosToLocCode(glm::u32vec3(512, 512, 512), 5), 5);
+	compact.CreateMesh(&empty, Octree::PosToLocCode(glm::u32vec3(512, 512, 512), 10));
+	CHECK(empty.vertexArray.empty());
+}
+
+/* The point of the compact layout: a fraction of the memory of the same tree of OctreeNodes */
+TEST(CompactOctreeMemory) {
+	CompactOctree compact = CompactOctree();
+	compact.InsertRandomNodes(nullptr, 6);
+	CHECK(compact.MemoryUsage() * 3 < compact.NodeCount() * sizeof(OctreeNode));
+}
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <cfloat>
+#include <random>
+#include "Test.h"
+#include "Core/Frustum.h"
+#include "Core/OcclusionCuller.h"
+#include "Core/Renderer.h"
+#include "World/Octree.h"
+
+/* A random camera in or around the world of the tests, looking anywhere */
+static Camera RandomCamera(std::mt19937& random) {
+	glm::vec3 position = glm::vec3(random() % 1400, random() % 600, random() % 1400) - glm::vec3(200.0f, 100.0f, 200.0f);
+	return Camera(position, glm::vec3(0.0f, 1.0f, 0.0f), (float)(random() % 360), (float)(random() % 170) - 85.0f);
+}
+
+static glm::mat4 ProjectionView(Camera camera) {
+	return Renderer::ProjectionMatrix(camera, 800, 600) * camera.GetViewMatrix();
+}
+
+/* True if the point is inside the clip volume of projection * view */
+static bool InClipVolume(const glm::mat4& projectionView, glm::vec3 point) {
+	glm::vec4 clip = projectionView * glm::vec4(point, 1.0f);
+	return std::abs(clip.x) <= clip.w && std::abs(clip.y) <= clip.w && std::abs(clip.z) <= clip.w;
+}
+
+/* TestBox against the clip volume, point by point: a box that is Outside has none of a grid of its points inside, and
+a box that is Inside has all of its corners inside */
+TEST(FrustumTestBoxMatchesPoints) {
+	std::mt19937 random(16);
+	for (int i = 0; i < 200; i++) {
+		Camera camera = RandomCamera(random);
+		glm::mat4 projectionView = ProjectionView(camera);
+		Frustum frustum(projectionView);
+		for (int j = 0; j < 200; j++) {
+			glm::vec3 min = camera.Position + glm::vec3(random() % 400, random() % 400, random() % 400) - glm::vec3(200.0f);
+			glm::vec3 max = min + glm::vec3(1 + random() % 64, 1 + random() % 64, 1 + random() % 64);
+			uint8_t mask = Frustum::ALLPLANES;
+			FrustumTest result = frustum.TestBox(min, max, mask);
+
+			size_t inside = 0;
+			for (int x = 0; x <= 4; x++) {
+				for (int y = 0; y <= 4; y++) {
+					for (int z = 0; z <= 4; z++) {
+						glm::vec3 point = min + (max - min) * glm::vec3(x, y, z) / 4.0f;
+						bool corner = (x % 4 == 0) && (y % 4 == 0) && (z % 4 == 0);
+						bool in = InClipVolume(projectionView, point);
+						inside += in;
+						CHECK(!(result == FrustumTest_Inside && corner && !in));
+					}
+				}
+			}
+			CHECK(!(result == FrustumTest_Outside && inside > 0));
+			CHECK((result == FrustumTest_Inside) == (mask == 0));
+			CHECK(result != FrustumTest_Outside || mask == Frustum::ALLPLANES);
+		}
+	}
+}
+
+/* The walk down the octree selects exactly the chunks that pass the test on their own, on a tree and on a DAG */
+TEST(VisibleChunksMatchPerChunkTest) {
+	Octree tree = Octree();
+	std::mt19937 random(17);
+	for (int i = 0; i < 3000; i++) {
+		tree.InsertNode(Octree::PosToLocCode(glm::u32vec3(random() % 1024, random() % 256, random() % 1024), 10), glm::vec4(1.0f));
+	}
+	tree.InsertNode(Octree::PosToLocCode(glm::u32vec3(512, 256, 512), 2), glm::vec4(1.0f));	// A block of 256^3
+	tree.TrackChunks(5);
+	std::vector<uint32_t> all;
+	tree.GetChunks(1, all);
+	uint32_t chunkSize = 1024 >> tree.GetChunkDepth();
+
+	for (bool dag : { false, true }) {
+		if (dag) {
+			tree.CompressToDAG();
+		}
+		for (int i = 0; i < 50; i++) {
+			Frustum frustum(ProjectionView(RandomCamera(random)));
+			std::vector<uint32_t> visible, expected;
+			tree.GetVisibleChunks(frustum, visible);
+			for (uint32_t chunk : all) {
+				glm::vec3 min = glm::vec3(Octree::LocCodeToPos(chunk));
+				uint8_t mask = Frustum::ALLPLANES;
+				if (frustum.TestBox(min, min + glm::vec3((float)chunkSize), mask) != FrustumTest_Outside) {
+					expected.push_back(chunk);
+				}
+			}
+			std::sort(visible.begin(), visible.end());
+			std::sort(expected.begin(), expected.end());
+			CHECK(visible == expected);
+		}
+	}
+}
+
+/* The default camera (yaw -90, pitch 0) looking straight at a flat wall, one solid block of 128^3 that fills the
+screen. The chunks that make up its front lie in the same plane as the face the block writes, so they stay visible,
+while the chunks further in are hidden */
+TEST(OcclusionFlatWall) {
+	Camera camera(glm::vec3(64.0f, 64.0f, 200.0f));
+	OcclusionCuller culler;
+	culler.Begin(ProjectionView(camera), camera.Position);
+	culler.AddOccluder(glm::vec3(0.0f), glm::vec3(128.0f));
+	culler.BuildPyramid();
+
+	for (float x = 0.0f; x < 128.0f; x += 32.0f) {
+		for (float y = 0.0f; y < 128.0f; y += 32.0f) {
+			CHECK(culler.IsVisible(glm::vec3(x, y, 96.0f), glm::vec3(x + 32.0f, y + 32.0f, 128.0f)));
+			CHECK(culler.IsVisible(glm::vec3(x, y, 127.0f), glm::vec3(x + 1.0f, y + 1.0f, 128.0f)));
+		}
+	}
+	CHECK(!culler.IsVisible(glm::vec3(32.0f, 32.0f, 64.0f), glm::vec3(64.0f, 64.0f, 96.0f)));
+	CHECK(!culler.IsVisible(glm::vec3(48.0f, 48.0f, -100.0f), glm::vec3(80.0f, 80.0f, -68.0f)));
+	CHECK(culler.IsVisible(glm::vec3(32.0f, 32.0f, 128.0f), glm::vec3(64.0f, 64.0f, 160.0f)));	// In front of it
+	CHECK(culler.IsVisible(glm::vec3(32.0f, 32.0f, 64.0f), glm::vec3(64.0f, 64.0f, 250.0f)));	// Reaching behind the eye
+}
+
+/* An occluder only writes the pixels it covers all of. With a projection that divides x and y by z, the depth
+buffer of 16^2 pixels spans -1 to 1 on x and y at z = 1, so a pixel is 0.125 wide there */
+TEST(OcclusionPartialPixels) {
+	glm::mat4 projection(1.0f);
+	projection[2][3] = 1.0f;	// w = z
+	projection[3][3] = 0.0f;
+	OcclusionCuller culler(16, 16);
+	culler.Begin(projection, glm::vec3(0.0f));
+	// Its front covers pixels 2.3 to 5.7 on x and y: the centers of pixels 2 to 5, but all of just pixels 3 and 4
+	auto pixel = [](float p) { return p / 8.0f - 1.0f; };
+	culler.AddOccluder(glm::vec3(pixel(2.3f), pixel(2.3f), 1.0f), glm::vec3(pixel(5.7f), pixel(5.7f), 1.001f));
+	for (unsigned int x = 0; x < 16; x++) {
+		for (unsigned int y = 0; y < 16; y++) {
+			bool covered = x >= 3 && x <= 4 && y >= 3 && y <= 4;
+			CHECK((culler.GetDepth(x, y) == 1.0f) == covered);
+			CHECK((culler.GetDepth(x, y) == FLT_MAX) == !covered);
+		}
+	}
+
+	// Behind it at z = 2, a box in the part of pixel 2 it doesn't cover is not hidden, one in pixels 3 and 4 is
+	culler.BuildPyramid();
+	CHECK(culler.IsVisible(glm::vec3(2.0f * pixel(2.05f), 2.0f * pixel(3.2f), 2.0f), glm::vec3(2.0f * pixel(2.25f), 2.0f * pixel(3.8f), 2.001f)));
+	CHECK(!culler.IsVisible(glm::vec3(2.0f * pixel(3.2f), 2.0f * pixel(3.2f), 2.0f), glm::vec3(2.0f * pixel(4.8f), 2.0f * pixel(4.8f), 2.001f)));
+}
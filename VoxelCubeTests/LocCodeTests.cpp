@@ -0,0 +1,113 @@
+#include <random>
+#include <unordered_set>
+#include "Test.h"
+#include "World/Octree.h"
+
+/* Location code of the node at the position and depth, built one level at a time: the reference for the Morton
+kernels */
+template <typename LocCode_t>
+static LocCode_t ReferenceLocCode(glm::u32vec3 pos, uint32_t depth, uint32_t maxDepth) {
+	LocCode_t code = 1;
+	for (uint32_t level = 1; level <= depth; level++) {
+		uint32_t bit = maxDepth - level;
+		code = (code << 3) | ((pos.x >> bit & 1) << 2) | ((pos.y >> bit & 1) << 1) | (pos.z >> bit & 1);
+	}
+	return code;
+}
+
+/* PosToLocCode and LocCodeToPos against the reference, at every depth, for positions all over the world */
+template <typename Tree, typename LocCode_t>
+static void CheckMorton(uint32_t maxDepth) {
+	std::mt19937_64 random(7);
+	for (int i = 0; i < 20000; i++) {
+		uint32_t depth = random() % (maxDepth + 1);
+		uint32_t size = maxDepth - depth;	// log2 of the node size
+		glm::u32vec3 corner = glm::u32vec3(random() % (1U << depth), random() % (1U << depth), random() % (1U << depth));
+		corner = glm::u32vec3(corner.x << size, corner.y << size, corner.z << size);
+
+		LocCode_t code = Tree::PosToLocCode(corner, depth);
+		CHECK(code == ReferenceLocCode<LocCode_t>(corner, depth, maxDepth));
+		CHECK(Tree::LocCodeToPos(code) == corner);
+		CHECK(Tree::GetLocDepth(code) == depth);
+	}
+}
+
+TEST(MortonMatchesReference) {
+	CheckMorton<Octree, uint32_t>(10);
+}
+
+/* The same for 64-bit codes, whose worlds are 2^21 blocks wide */
+TEST(Morton64MatchesReference) {
+	CheckMorton<Octree64, uint64_t>(21);
+}
+
+/* An Octree64 holds blocks beyond the 1024^3 of Octree, and meshes them like Octree meshes the same blocks near
+the origin */
+TEST(Octree64BeyondOctree) {
+	Octree near = Octree();
+	Octree64 far = Octree64();
+	glm::u32vec3 offset = glm::u32vec3(1U << 20, 3U << 15, (1U << 21) - 64);
+	std::mt19937 random(8);
+	for (int i = 0; i < 2000; i++) {
+		glm::u32vec3 pos = glm::u32vec3(random() % 32, random() % 32, random() % 32);
+		near.InsertNode(Octree::PosToLocCode(pos, 10), glm::vec4(1.0f));
+		far.InsertNode(Octree64::PosToLocCode(pos + offset, 21), glm::vec4(1.0f));
+	}
+	CHECK(far.NodeCount() == near.NodeCount() + 11);	// The 11 levels between the two chunks and their roots
+
+	Renderer nearMesh, farMesh;
+	near.CreateMesh(&nearMesh, Octree::PosToLocCode(glm::u32vec3(0), 5), 5);
+	far.CreateMesh(&farMesh, Octree64::PosToLocCode(offset, 16), 5);
+	CHECK(!farMesh.vertexArray.empty());
+	CHECK(farMesh.vertexArray == nearMesh.vertexArray);
+	CHECK(farMesh.GetMeshOrigin() == offset);
+}
+
+/* NeighborLocCode against moving the node's position by its size, for every face, at every depth, including the
+edges of the world */
+TEST(NeighborLocCodeMatchesPosition) {
+	std::mt19937 random(9);
+	for (int i = 0; i < 20000; i++) {
+		uint32_t depth = 1 + random() % 10;
+		uint32_t cells = 1U << depth;	// Nodes per axis at this depth
+		glm::u32vec3 cell = glm::u32vec3(random() % cells, random() % cells, random() % cells);
+		if (i % 4 == 0) {
+			cell[random() % 3] = (random() % 2) * (cells - 1);	// On the edge of the world
+		}
+		uint32_t size = 1U << (10 - depth);
+		uint32_t code = Octree::PosToLocCode(cell * size, depth);
+
+		for (uint8_t face = 0; face < 6; face++) {
+			// Faces are numbered like the visibility bits: x, y, z from the high bits down, the + side first
+			int axis = 2 - face / 2;
+			int step = (face & 1) ? -1 : 1;
+			glm::ivec3 neighbor = glm::ivec3(cell);
+			neighbor[axis] += step;
+			bool inside = neighbor[axis] >= 0 && neighbor[axis] < (int)cells;
+			uint32_t expected = inside ? Octree::PosToLocCode(glm::u32vec3(neighbor) * size, depth) : 0;
+			CHECK(Octree::NeighborLocCode(code, face) == expected);
+		}
+	}
+}
+
+/* Faces culled on insert, with the neighbors found through NeighborLocCode and GetNeighbor: a face of a block is
+shown exactly when there is no block on the other side */
+TEST(NeighborCullingMatchesOccupancy) {
+	Octree tree = Octree();
+	std::mt19937 random(10);
+	std::unordered_set<uint32_t> blocks;
+	for (int i = 0; i < 6000; i++) {
+		uint32_t code = Octree::PosToLocCode(glm::u32vec3(random() % 24, random() % 24, random() % 24), 10);
+		tree.InsertNode(code, glm::vec4(1.0f));
+		blocks.insert(code);
+	}
+
+	for (uint32_t code : blocks) {
+		uint8_t visibility = tree.GetNode(code)->visibility;
+		for (uint8_t face = 0; face < 6; face++) {
+			uint32_t neighbor = Octree::NeighborLocCode(code, face);
+			bool shown = (visibility >> face) & 1;
+			CHECK(shown == (blocks.count(neighbor) == 0));
+		}
+	}
+}
@@ -0,0 +1,47 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include "Test.h"
+
+int main() {
+    // Hidden window, only for its GL context. Same version as the game asks for
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    #ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    #endif
+
+    GLFWwindow* window = glfwCreateWindow(64, 64, "VoxelCubeTests", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+
+    size_t failed = 0;
+    for (const Test::TestCase& test : Test::Registry())
+    {
+        Test::Failures() = 0;
+        test.function();
+        std::cout << (Test::Failures() == 0 ? "[ OK ] " : "[FAIL] ") << test.name << std::endl;
+        if (Test::Failures() != 0) {
+            failed++;
+        }
+    }
+    std::cout << Test::Registry().size() - failed << " of " << Test::Registry().size() << " tests passed" << std::endl;
+
+    glfwTerminate();
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+#include <glad/glad.h>
+#include <map>
+#include <random>
+#include <set>
+#include "Test.h"
+#include "Core/MeshBuffer.h"
+#include "Core/Renderer.h"
+#include "World/Octree.h"
+
+/* Frames of random uploads and frees, starting from a buffer too small for them. Live meshes never overlap, and
+what the buffer holds is what was uploaded, also after the buffer grew */
+TEST(MeshBufferChurn) {
+	MeshBuffer buffer(4096);
+	std::mt19937 random(15);
+	std::map<size_t, std::vector<uint32_t>> live;	// First vertex -> the mesh uploaded there
+	uint32_t serial = 0;
+	GLint vbo = 0;
+
+	for (int frame = 1; frame <= 400; frame++) {
+		for (int i = 0; i < 4; i++) {
+			std::vector<uint32_t> mesh(4 * (1 + random() % 500));
+			for (uint32_t& vertex : mesh) {
+				vertex = serial++;
+			}
+			size_t first = buffer.Upload(mesh);
+			// Without the persistent mapping, the upload leaves the buffer bound. It is replaced when the buffer grows
+			glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &vbo);
+			live[first] = mesh;
+		}
+		for (int i = 0; i < 3 && !live.empty(); i++) {
+			auto mesh = live.begin();
+			std::advance(mesh, random() % live.size());
+			buffer.Free(mesh->first, mesh->second.size());
+			live.erase(mesh);
+		}
+		buffer.EndFrame();
+
+		size_t end = 0;
+		for (auto& mesh : live) {
+			CHECK(mesh.first >= end);
+			end = mesh.first + mesh.second.size();
+		}
+		CHECK(end <= buffer.Capacity());
+
+		if (frame % 50 == 0 && !buffer.IsPersistent()) {
+			glBindBuffer(GL_ARRAY_BUFFER, vbo);
+			size_t wrong = 0;
+			for (auto& mesh : live) {
+				std::vector<uint32_t> contents(mesh.second.size());
+				glGetBufferSubData(GL_ARRAY_BUFFER, mesh.first * sizeof(uint32_t), contents.size() * sizeof(uint32_t), contents.data());
+				wrong += contents != mesh.second;
+			}
+			CHECK(wrong == 0);
+		}
+		glFinish();	// Let the fences of this frame signal, so the freed ranges come back
+	}
+
+	CHECK(buffer.Capacity() > 4096);
+	CHECK(glGetError() == GL_NO_ERROR);
+	buffer.Delete();
+}
+
+/* Draw the meshes through a MeshBuffer into a framebuffer of 128^2, and read its pixels back */
+static std::vector<uint8_t> DrawMeshes(std::vector<Renderer>& meshes, BlockShader& shader, Camera camera, bool allowMultiDraw, bool& multiDraw) {
+	const unsigned int SIZE = 128;
+	GLuint framebuffer, color, depth;
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glGenRenderbuffers(1, &color);
+	glBindRenderbuffer(GL_RENDERBUFFER, color);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, SIZE, SIZE);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+	glGenRenderbuffers(1, &depth);
+	glBindRenderbuffer(GL_RENDERBUFFER, depth);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, SIZE, SIZE);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+	glViewport(0, 0, SIZE, SIZE);
+	glEnable(GL_DEPTH_TEST);
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	MeshBuffer buffer(4096, allowMultiDraw);
+	Renderer::UseShader(&shader, camera, SIZE, SIZE);
+	for (Renderer& mesh : meshes) {
+		size_t first = buffer.Upload(mesh.vertexArray);
+		buffer.AddDraw(first, mesh.vertexArray.size() / Renderer::FACESIZE, glm::vec3(mesh.GetMeshOrigin()), (float)mesh.GetMeshUnit());
+	}
+	buffer.Draw();
+	multiDraw = buffer.IsMultiDraw();
+
+	std::vector<uint8_t> pixels(SIZE * SIZE * 4);
+	glReadPixels(0, 0, SIZE, SIZE, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	buffer.Delete();
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glDeleteRenderbuffers(1, &color);
+	glDeleteRenderbuffers(1, &depth);
+	glDeleteFramebuffers(1, &framebuffer);
+	return pixels;
+}
+
+/* Four chunks of hills, one of them at a coarser unit, drawn with the multi-draw and with the loop of single draws
+give the same image. Where the context has no GL 4.3, both draws loop */
+TEST(MeshBufferDrawPathsMatch) {
+	Octree world = Octree();
+	for (uint32_t x = 0; x < 64; x++) {
+		for (uint32_t z = 0; z < 64; z++) {
+			uint32_t height = 4 + (x * 7 + z * z) % 13;
+			for (uint32_t y = 0; y < height; y++) {
+				world.InsertNode(Octree::PosToLocCode(glm::u32vec3(x, y, z), 10), glm::vec4(1.0f), (uint16_t)(1 + (x + z) / 16 % 4));
+			}
+		}
+	}
+	std::vector<Renderer> meshes(4);
+	for (uint32_t i = 0; i < 4; i++) {
+		uint32_t chunk = Octree::PosToLocCode(glm::u32vec3(32 * (i & 1), 0, 32 * (i >> 1)), 5);
+		world.CreateMesh(&meshes[i], chunk, i == 3 ? 3 : 5, MeshingMode_BinaryGreedy);
+		CHECK(!meshes[i].vertexArray.empty());
+	}
+	CHECK(meshes[3].GetMeshUnit() == 4);
+
+	BlockShader shader("Core/VertexShader.txt", "Core/FragmentShader.txt");
+	Camera camera(glm::vec3(32.0f, 50.0f, 110.0f), glm::vec3(0.0f, 1.0f, 0.0f), -90.0f, -27.0f);
+	bool multiDraw = false, loopMultiDraw = true;
+	std::vector<uint8_t> multi = DrawMeshes(meshes, shader, camera, true, multiDraw);
+	std::vector<uint8_t> loop = DrawMeshes(meshes, shader, camera, false, loopMultiDraw);
+	CHECK(!loopMultiDraw);
+	CHECK(multi == loop);
+
+	// Something was drawn, in more than one color as the block types differ
+	std::set<uint32_t> colors;
+	for (size_t i = 0; i < loop.size(); i += 4) {
+		colors.insert(loop[i] | loop[i + 1] << 8 | loop[i + 2] << 16);
+	}
+	CHECK(colors.count(0) == 1);
+	CHECK(colors.size() > 8);
+	CHECK(glGetError() == GL_NO_ERROR);
+}
@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <random>
+#include <tuple>
+#include "Test.h"
+#include "World/Octree.h"
+
+typedef std::tuple<uint8_t, uint32_t, uint32_t, uint32_t, uint16_t> UnitFace;	// Face, x, y, z, type
+
+/* The unit squares a mesh covers, sorted. Quads that span several units are cut up, so meshes that cover the same
+surface with different quads compare equal */
+static std::vector<UnitFace> UnitFaces(const Renderer& renderer) {
+	std::vector<UnitFace> faces;
+	for (size_t i = 0; i + 3 < renderer.vertexArray.size(); i += 4) {
+		uint32_t low[3] = { UINT32_MAX, UINT32_MAX, UINT32_MAX };
+		uint32_t high[3] = { 0, 0, 0 };
+		uint8_t face;
+		uint16_t type;
+		for (size_t v = 0; v < 4; v++) {
+			uint32_t pos[3];
+			Renderer::UnpackVertex(renderer.vertexArray[i + v], pos[0], pos[1], pos[2], face, type);
+			for (int axis = 0; axis < 3; axis++) {
+				low[axis] = std::min(low[axis], pos[axis]);
+				high[axis] = std::max(high[axis], pos[axis]);
+			}
+		}
+		high[face / 2] = low[face / 2] + 1;	// The quad is flat along its own axis
+		for (uint32_t x = low[0]; x < high[0]; x++) {
+			for (uint32_t y = low[1]; y < high[1]; y++) {
+				for (uint32_t z = low[2]; z < high[2]; z++) {
+					faces.push_back(UnitFace(face, x, y, z, type));
+				}
+			}
+		}
+	}
+	std::sort(faces.begin(), faces.end());
+	return faces;
+}
+
+/* Blocks of one size, so the visibility bits and the occupancy masks agree on every face. Meshed per 32^3 chunk and
+per 4^3 box, with neighbors across the box borders, all modes cover the same unit faces */
+TEST(MeshersCoverSameFaces) {
+	Octree tree = Octree();
+	std::mt19937 random(12);
+	for (int i = 0; i < 15000; i++) {
+		glm::u32vec3 pos = glm::u32vec3(random() % 64, random() % 40, random() % 64);
+		tree.InsertNode(Octree::PosToLocCode(pos, 10), glm::vec4(1.0f), 1 + (pos.y / 8) % 3);
+	}
+
+	size_t naiveFaces = 0, greedyFaces = 0;
+	for (uint32_t boxDepth : { 5, 8 }) {
+		uint32_t size = 1U << (10 - boxDepth);
+		for (uint32_t x = 0; x < 64; x += size * 3) {
+			for (uint32_t z = 0; z < 64; z += size * 5) {
+				uint32_t box = Octree::PosToLocCode(glm::u32vec3(x, 0, z), boxDepth);
+				Renderer naive, greedy, binary, binaryGreedy;
+				tree.CreateMesh(&naive, box, 10 - boxDepth, MeshingMode_Naive);
+				tree.CreateMesh(&greedy, box, 10 - boxDepth, MeshingMode_Greedy);
+				tree.CreateMesh(&binary, box, 10 - boxDepth, MeshingMode_Binary);
+				tree.CreateMesh(&binaryGreedy, box, 10 - boxDepth, MeshingMode_BinaryGreedy);
+
+				std::vector<UnitFace> faces = UnitFaces(naive);
+				CHECK(!faces.empty());
+				CHECK(UnitFaces(greedy) == faces);
+				CHECK(UnitFaces(binary) == faces);
+				CHECK(UnitFaces(binaryGreedy) == faces);
+				CHECK(binary.vertexArray.size() == naive.vertexArray.size());
+				CHECK(greedy.vertexArray.size() <= naive.vertexArray.size());
+				CHECK(binaryGreedy.vertexArray.size() == greedy.vertexArray.size());
+				naiveFaces += naive.vertexArray.size();
+				greedyFaces += greedy.vertexArray.size();
+			}
+		}
+	}
+	CHECK(greedyFaces < naiveFaces);
+}
@@ -0,0 +1,95 @@
+#include <random>
+#include <unordered_set>
+#include "Test.h"
+#include "World/NodePool.h"
+#include "World/Octree.h"
+
+struct PoolItem {
+	uint64_t value;	// As big as the free list pointer, so a slot is exactly one item
+	PoolItem(uint64_t value) : value(value) { };
+};
+
+/* Random allocations and frees. Live nodes never share a slot, keep their contents, and freed slots are reused
+before the pool grows */
+TEST(NodePoolChurn) {
+	NodePool<PoolItem, 64> pool;
+	std::vector<PoolItem*> live;
+	std::vector<uint64_t> values;	// Parallel to live, what each node should still hold
+	std::mt19937 random(1);
+	size_t peak = 0;
+
+	for (uint64_t i = 0; i < 20000; i++) {
+		if (live.empty() || random() % 3 != 0) {
+			live.push_back(pool.Allocate(i));
+			values.push_back(i);
+		}
+		else {
+			size_t j = random() % live.size();
+			pool.Free(live[j]);
+			live[j] = live.back();
+			live.pop_back();
+			values[j] = values.back();
+			values.pop_back();
+		}
+		peak = std::max(peak, live.size());
+		if (i % 1000 == 0) {
+			// Churn in place: free everything but the first node, then allocate as many again
+			for (size_t j = 1; j < live.size(); j++) {
+				pool.Free(live[j]);
+			}
+			size_t capacity = pool.Capacity();
+			for (size_t j = 1; j < live.size(); j++) {
+				live[j] = pool.Allocate(i);
+				values[j] = i;
+			}
+			CHECK(pool.Capacity() == capacity);
+		}
+	}
+
+	for (size_t j = 0; j < live.size(); j++) {
+		CHECK(live[j]->value == values[j]);
+	}
+	CHECK(pool.Size() == live.size());
+	std::unordered_set<PoolItem*> slots(live.begin(), live.end());
+	CHECK(slots.size() == live.size());
+	// The pool never holds more blocks than the most nodes that were live at once need
+	CHECK(pool.Capacity() <= (peak + 63) / 64 * 64 * sizeof(PoolItem));
+
+	pool.Clear();
+	CHECK(pool.Size() == 0);
+	CHECK(pool.Capacity() == 0);
+	CHECK(pool.Allocate(7)->value == 7);
+}
+
+/* Building and removing the same world over and over in one tree keeps its node count and mesh */
+TEST(OctreeNodeChurn) {
+	Octree tree = Octree();
+	glm::vec4 color = glm::vec4(1.0f);
+	std::mt19937 random(2);
+	std::vector<uint32_t> codes;
+	for (int i = 0; i < 2000; i++) {
+		codes.push_back(Octree::PosToLocCode(glm::u32vec3(random() % 32, random() % 32, random() % 32), 10));
+	}
+	uint32_t chunk = Octree::PosToLocCode(glm::u32vec3(0), 5);	// The 32^3 node the blocks are in
+
+	size_t nodes = 0;
+	std::vector<uint32_t> mesh;
+	for (int round = 0; round < 5; round++) {
+		for (uint32_t code : codes) {
+			tree.InsertNode(code, color);
+		}
+		Renderer renderer;
+		tree.CreateMesh(&renderer, chunk, 5);
+		if (round == 0) {
+			nodes = tree.NodeCount();
+			mesh = renderer.vertexArray;
+		}
+		CHECK(tree.NodeCount() == nodes);
+		CHECK(renderer.vertexArray == mesh);
+
+		for (uint32_t code : codes) {
+			tree.RemoveNode(code);
+		}
+		CHECK(tree.NodeCount() == 1);
+	}
+}
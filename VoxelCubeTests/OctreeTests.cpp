@@ -0,0 +1,363 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include "Test.h"
+#include "World/Octree.h"
+
+/* The meshes of the 8 chunks of 32^3 blocks in the corner of the world that the tests build in, one after the other */
+static std::vector<uint32_t> CornerMesh(Octree& tree, MeshingMode mode = MeshingMode_Naive) {
+	std::vector<uint32_t> mesh;
+	for (uint32_t i = 0; i < 8; i++) {
+		Renderer renderer;
+		glm::u32vec3 pos = glm::u32vec3(i >> 2 & 1, i >> 1 & 1, i & 1) * 32U;
+		tree.CreateMesh(&renderer, Octree::PosToLocCode(pos, 5), 5, mode);
+		mesh.insert(mesh.end(), renderer.vertexArray.begin(), renderer.vertexArray.end());
+	}
+	return mesh;
+}
+
+/* A random LocCode in the corner, mostly of single blocks, sometimes of a node of 2^3 or 4^3 blocks */
+static uint32_t RandomLocCode(std::mt19937& random) {
+	uint32_t depth = 10 - (random() % 8 == 0 ? 1 + random() % 2 : 0);
+	uint32_t size = 1U << (10 - depth);
+	glm::u32vec3 pos = glm::u32vec3(random() % 64, random() % 64, random() % 64) / size * size;
+	return Octree::PosToLocCode(pos, depth);
+}
+
+/* Terrain that repeats every 16 blocks, so there is plenty for the DAG to share */
+static void InsertTerrain(Octree& tree) {
+	for (uint32_t x = 0; x < 64; x++) {
+		for (uint32_t z = 0; z < 64; z++) {
+			uint32_t height = 4 + (x * 7 + z * 3) % 16 / 2;
+			for (uint32_t y = 0; y < height; y++) {
+				tree.InsertNode(Octree::PosToLocCode(glm::u32vec3(x, y, z), 10), glm::vec4(1.0f), 1 + (uint16_t)(y % 3));
+			}
+		}
+	}
+}
+
+/* Compressing merges the repeated subtrees, but what is meshed stays the same */
+TEST(DAGCompressKeepsMesh) {
+	Octree tree = Octree();
+	InsertTerrain(tree);
+	std::vector<uint32_t> naive = CornerMesh(tree);
+	std::vector<uint32_t> binary = CornerMesh(tree, MeshingMode_BinaryGreedy);
+	size_t nodes = tree.NodeCount();
+
+	DAGStats stats = tree.CompressToDAG();
+	CHECK(stats.nodesBefore == nodes);
+	CHECK(stats.nodesAfter == tree.NodeCount());
+	CHECK(stats.nodesAfter * 4 < stats.nodesBefore);
+	CHECK(CornerMesh(tree) == naive);
+	CHECK(CornerMesh(tree, MeshingMode_BinaryGreedy) == binary);
+
+	// Compressing again finds nothing new
+	CHECK(tree.CompressToDAG().nodesAfter == stats.nodesAfter);
+}
+
+/* The same random edits on a DAG and on a plain tree. Copy-on-write keeps the other places a shared node is used
+as they were, so both mesh the same throughout, and the DAG stays smaller */
+TEST(DAGCopyOnWriteEdits) {
+	Octree tree = Octree();
+	Octree dag = Octree();
+	InsertTerrain(tree);
+	InsertTerrain(dag);
+	dag.CompressToDAG();
+
+	std::mt19937 random(4);
+	for (int i = 1; i <= 2000; i++) {
+		uint32_t code = RandomLocCode(random);
+		if (random() % 2 == 0) {
+			uint16_t id = 1 + random() % 3;
+			tree.InsertNode(code, glm::vec4(1.0f), id);
+			dag.InsertNode(code, glm::vec4(1.0f), id);
+		}
+		else {
+			tree.RemoveNode(code);
+			dag.RemoveNode(code);
+		}
+		if (i % 250 == 0) {
+			CHECK(CornerMesh(dag) == CornerMesh(tree));
+			CHECK(CornerMesh(dag, MeshingMode_BinaryGreedy) == CornerMesh(tree, MeshingMode_BinaryGreedy));
+			CHECK(dag.NodeCount() < tree.NodeCount());
+		}
+	}
+
+	// An edit that undoes itself leaves the DAG as compressed as it was
+	size_t nodes = dag.NodeCount();
+	uint32_t code = Octree::PosToLocCode(glm::u32vec3(40, 60, 40), 10);
+	dag.InsertNode(code, glm::vec4(1.0f), 2);
+	dag.RemoveNode(code);
+	CHECK(dag.NodeCount() == nodes);
+}
+
+/* Removing blocks gives the tree that never had them: the same nodes, ids and culled faces. That covers the
+neighbors of a removed block showing their faces again, and ancestors without children going away */
+TEST(RemoveNodeMatchesFreshTree) {
+	std::mt19937 random(5);
+	std::vector<uint32_t> kept, removed;
+	for (uint32_t x = 0; x < 64; x++) {
+		for (uint32_t y = 0; y < 24; y++) {
+			for (uint32_t z = 0; z < 64; z++) {
+				uint32_t code = Octree::PosToLocCode(glm::u32vec3(x, y, z), 10);
+				if (random() % 4 == 0) {
+					removed.push_back(code);
+				}
+				else if (random() % 2 == 0 && !(x >= 16 && x < 24 && z >= 16 && z < 24)) {
+					kept.push_back(code);
+				}
+			}
+		}
+	}
+	// Blocks in an 8^3 node that is removed as a whole
+	uint32_t bigNode = Octree::PosToLocCode(glm::u32vec3(16, 8, 16), 7);
+	for (uint32_t x = 16; x < 24; x++) {
+		for (uint32_t z = 16; z < 24; z++) {
+			removed.push_back(Octree::PosToLocCode(glm::u32vec3(x, 8 + (x + z) % 8, z), 10));
+		}
+	}
+
+	// The removed blocks are inserted in between the kept ones, so they are culled against each other
+	std::vector<uint32_t> all = kept;
+	all.insert(all.end(), removed.begin(), removed.end());
+	std::shuffle(all.begin(), all.end(), random);
+
+	Octree edited = Octree();
+	Octree fresh = Octree();
+	for (uint32_t code : all) {
+		edited.InsertNode(code, glm::vec4(1.0f), 1 + code % 3);
+	}
+	for (uint32_t code : kept) {
+		fresh.InsertNode(code, glm::vec4(1.0f), 1 + code % 3);
+	}
+	for (uint32_t code : removed) {
+		if ((code >> 9) != bigNode) {
+			edited.RemoveNode(code);
+		}
+	}
+	edited.RemoveNode(bigNode);
+
+	CHECK(edited.NodeCount() == fresh.NodeCount());
+	CHECK(edited.GetNode(1)->id == fresh.GetNode(1)->id);
+	CHECK(edited.GetNode(bigNode) == nullptr);
+	for (uint32_t code : kept) {
+		CHECK(edited.GetNode(code)->visibility == fresh.GetNode(code)->visibility);
+	}
+	CHECK(CornerMesh(edited) == CornerMesh(fresh));
+	CHECK(CornerMesh(edited, MeshingMode_Binary) == CornerMesh(fresh, MeshingMode_Binary));
+}
+
+/* InsertBatch gives the same tree as InsertNode in order, also when the voxels overlap: the same block twice, a node
+over blocks inserted before it, and blocks inside a node inserted before them */
+TEST(InsertBatchMatchesInsertNode) {
+	std::mt19937 random(6);
+	std::vector<VoxelInsert> voxels;
+	for (int i = 0; i < 20000; i++) {
+		voxels.push_back({ RandomLocCode(random), glm::vec4(0.1f * (i % 10), 0.5f, 0.5f, 1.0f), (uint16_t)(1 + random() % 5) });
+	}
+	std::vector<VoxelInsert> batch = voxels;
+
+	Octree single = Octree();
+	Octree batched = Octree();
+	for (const VoxelInsert& voxel : voxels) {
+		single.InsertNode(voxel.LocCode, voxel.color, voxel.id);
+	}
+	batched.InsertBatch(batch);
+
+	CHECK(batched.NodeCount() == single.NodeCount());
+	for (const VoxelInsert& voxel : voxels) {
+		OctreeNode* a = single.GetNode(voxel.LocCode);
+		OctreeNode* b = batched.GetNode(voxel.LocCode);
+		CHECK(a->id == b->id);
+		CHECK(a->visibility == b->visibility);
+		CHECK(a->color == b->color);
+	}
+	CHECK(CornerMesh(batched) == CornerMesh(single));
+	CHECK(CornerMesh(batched, MeshingMode_Greedy) == CornerMesh(single, MeshingMode_Greedy));
+
+	// In a DAG, the batch is inserted one by one
+	std::vector<VoxelInsert> more;
+	for (int i = 0; i < 500; i++) {
+		more.push_back({ RandomLocCode(random), glm::vec4(1.0f), (uint16_t)(1 + random() % 5) });
+	}
+	batched.CompressToDAG();
+	for (const VoxelInsert& voxel : more) {
+		single.InsertNode(voxel.LocCode, voxel.color, voxel.id);
+	}
+	batched.InsertBatch(more);
+	CHECK(CornerMesh(batched) == CornerMesh(single));
+}
+
+/* With the index, GetNode finds the same nodes as the walk from the root, through inserts, batches and removes. The
+index is built from the tree when enabled later, and dropped by CompressToDAG */
+TEST(IndexMatchesWalk) {
+	Octree indexed = Octree();
+	Octree walked = Octree();
+	indexed.EnableIndex(true);
+	CHECK(indexed.IsIndexed());
+
+	std::mt19937 random(11);
+	auto checkLookups = [&](Octree& tree) {
+		for (int i = 0; i < 2000; i++) {
+			uint32_t code = RandomLocCode(random) >> (3 * (random() % 4));	// Blocks, nodes above them, and missing ones
+			OctreeNode* a = tree.GetNode(code);
+			OctreeNode* b = walked.GetNode(code);
+			CHECK((a == nullptr) == (b == nullptr));
+			if (a != nullptr && b != nullptr) {
+				CHECK(a->LocCode == code);
+				CHECK(a->id == b->id);
+			}
+		}
+	};
+
+	for (int round = 0; round < 10; round++) {
+		std::vector<VoxelInsert> batch;
+		for (int i = 0; i < 1000; i++) {
+			uint32_t code = RandomLocCode(random);
+			if (random() % 3 == 0) {
+				indexed.RemoveNode(code);
+				walked.RemoveNode(code);
+			}
+			else if (random() % 2 == 0) {
+				indexed.InsertNode(code, glm::vec4(1.0f), 2);
+				walked.InsertNode(code, glm::vec4(1.0f), 2);
+			}
+			else {
+				batch.push_back({ code, glm::vec4(1.0f), 3 });
+			}
+		}
+		std::vector<VoxelInsert> copy = batch;
+		indexed.InsertBatch(batch);
+		walked.InsertBatch(copy);
+		checkLookups(indexed);
+	}
+
+	Octree late = Octree();
+	InsertTerrain(late);
+	late.EnableIndex(true);
+	for (uint32_t x = 0; x < 64; x += 3) {
+		for (uint32_t z = 0; z < 64; z += 5) {
+			uint32_t code = Octree::PosToLocCode(glm::u32vec3(x, 3, z), 10);	// The terrain is at least 4 high
+			CHECK(late.GetNode(code) != nullptr && late.GetNode(code)->LocCode == code);
+			CHECK(late.GetNode(Octree::PosToLocCode(glm::u32vec3(x, 20, z), 10)) == nullptr);
+		}
+	}
+
+	late.CompressToDAG();
+	CHECK(!late.IsIndexed());
+}
+
+/* The blocks of a node, added up unit by unit */
+struct BlockSum {
+	uint64_t units = 0;
+	double color[4] = { 0.0, 0.0, 0.0, 0.0 };	// Summed over the units
+};
+
+/* Check the summary of every node under this one, the node included, against the blocks it holds. Only follows
+Children, so it works in a DAG. Returns the blocks of the node */
+static BlockSum CheckSummaries(OctreeNode* node, uint32_t depth, size_t& checked) {
+	BlockSum sum;
+	uint32_t levels = 10 - depth;
+	float volumes[8];	// The children's fill per type, the types in types[]
+	uint16_t types[8];
+	int typeCount = 0;
+	for (OctreeNode* child : node->Children) {
+		if (child == nullptr) {
+			continue;
+		}
+		BlockSum blocks = CheckSummaries(child, depth + 1, checked);
+		sum.units += blocks.units;
+		for (int c = 0; c < 4; c++) {
+			sum.color[c] += blocks.color[c];
+		}
+		int t = 0;
+		while (t < typeCount && types[t] != child->type) {
+			t++;
+		}
+		if (t == typeCount) {
+			types[typeCount] = child->type;
+			volumes[typeCount++] = 0.0f;
+		}
+		volumes[t] += child->fill;
+	}
+
+	if (typeCount == 0) {
+		// Without children a node is a block or nothing, and its summary is its own
+		if (node->isLeaf) {
+			sum.units = 1ULL << (3 * levels);
+			for (int c = 0; c < 4; c++) {
+				sum.color[c] = (double)node->color[c] * sum.units;
+			}
+		}
+		CHECK(node->isSolid == node->isLeaf);
+		CHECK(node->fill == (node->isLeaf ? 1.0f : 0.0f));
+		CHECK(node->type == (node->isLeaf ? node->id : 0));
+		return sum;
+	}
+
+	// The fill is a sum of powers of two that a float holds exactly. The color is an average rounded at every level
+	CHECK(node->fill == std::ldexp((float)sum.units, -3 * (int)levels));
+	CHECK(node->isSolid == (sum.units == 1ULL << (3 * levels)));
+	for (int c = 0; c < 4; c++) {
+		double color = sum.units > 0 ? sum.color[c] / sum.units : 0.0;
+		CHECK(std::abs(node->color[c] - color) < 1e-5);
+	}
+	// The type is a type of the children with the most fill, which ties are free to break either way
+	float most = 0.0f;
+	int type = -1;
+	for (int t = 0; t < typeCount; t++) {
+		most = std::max(most, volumes[t]);
+		type = types[t] == node->type ? t : type;
+	}
+	CHECK(type >= 0 && volumes[type] == most);
+	checked++;
+	return sum;
+}
+
+/* Random inserts, removes and batches on a plain tree and on a DAG, after which every node's fill, color, solidity and
+type still add up to the blocks below it */
+TEST(SummariesMatchBlocks) {
+	Octree tree = Octree();
+	Octree dag = Octree();
+	InsertTerrain(tree);
+	InsertTerrain(dag);
+	dag.CompressToDAG();
+
+	std::mt19937 random(24);
+	auto randomColor = [&]() {
+		return glm::vec4((random() % 9) / 8.0f, (random() % 9) / 8.0f, (random() % 9) / 8.0f, 1.0f);
+	};
+	for (int i = 1; i <= 600; i++) {
+		uint32_t edit = random() % 3;
+		if (edit == 0) {
+			uint32_t code = RandomLocCode(random);
+			glm::vec4 color = randomColor();
+			uint16_t id = 1 + random() % 4;
+			tree.InsertNode(code, color, id);
+			dag.InsertNode(code, color, id);
+		}
+		else if (edit == 1) {
+			uint32_t code = RandomLocCode(random);
+			tree.RemoveNode(code);
+			dag.RemoveNode(code);
+		}
+		else {
+			std::vector<VoxelInsert> voxels;
+			for (int v = 0; v < 40; v++) {
+				voxels.push_back({ RandomLocCode(random), randomColor(), (uint16_t)(1 + random() % 4) });
+			}
+			std::vector<VoxelInsert> copy = voxels;
+			tree.InsertBatch(voxels);
+			dag.InsertBatch(copy);
+		}
+
+		if (i % 100 == 0) {
+			size_t treeNodes = 0, dagNodes = 0;
+			BlockSum treeBlocks = CheckSummaries(tree.GetNode(1), 0, treeNodes);
+			BlockSum dagBlocks = CheckSummaries(dag.GetNode(1), 0, dagNodes);
+			CHECK(treeBlocks.units > 0);
+			CHECK(dagBlocks.units == treeBlocks.units);
+			CHECK(dagNodes == treeNodes);	// Shared nodes are checked at every place they are used
+		}
+	}
+}
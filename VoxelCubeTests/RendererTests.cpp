@@ -0,0 +1,61 @@
+#include "Test.h"
+#include "Core/Renderer.h"
+
+/* Every position in a mesh box, from 0 to 32 inclusive, with every face and a spread of the 2048 block types */
+TEST(PackVertexRoundTrip) {
+	for (uint32_t x = 0; x <= 32; x++) {
+		for (uint32_t y = 0; y <= 32; y++) {
+			for (uint32_t z = 0; z <= 32; z++) {
+				for (uint8_t face = 0; face < 6; face++) {
+					uint16_t type = (uint16_t)((x * 97 + y * 31 + z * 7 + face) % 2048);
+					for (uint16_t t : { type, (uint16_t)0, (uint16_t)2047 }) {
+						uint32_t vertex = Renderer::PackVertex(x, y, z, face, t);
+						uint32_t ux, uy, uz;
+						uint8_t uface;
+						uint16_t utype;
+						Renderer::UnpackVertex(vertex, ux, uy, uz, uface, utype);
+						CHECK(ux == x && uy == y && uz == z && uface == face && utype == t);
+					}
+				}
+			}
+		}
+	}
+}
+
+/* CreateCube writes a quad for exactly the visible faces, each lying on its own side of the cube, and with room
+reserved it never grows the vertex array */
+TEST(CreateCubeFaces) {
+	Renderer renderer;
+	renderer.SetMeshOrigin(glm::u32vec3(64, 0, 128), 2);
+	renderer.ReserveFaces(64 * 6);
+	size_t capacity = renderer.vertexArray.capacity();
+
+	for (uint32_t visibility = 0; visibility < 64; visibility++) {
+		size_t first = renderer.vertexArray.size();
+		// A cube of 2 units at local (3, 5, 7), with the face bits in the order of Octree.h
+		renderer.CreateCube(64 + 6, 10, 128 + 14, 4, (uint8_t)visibility, 9);
+		size_t written = renderer.vertexArray.size() - first;
+		CHECK(written == Renderer::FaceCount((uint8_t)visibility) * Renderer::FACESIZE);
+
+		// Visibility bit i is face 5 - i of PackVertex (bit 5 is -x, face 0 is -x)
+		size_t quad = 0;
+		for (uint8_t face = 0; face < 6; face++) {
+			if (!((visibility >> (5 - face)) & 1)) { continue; }
+			for (size_t v = 0; v < 4; v++) {
+				uint32_t x, y, z;
+				uint8_t vface;
+				uint16_t type;
+				Renderer::UnpackVertex(renderer.vertexArray[first + quad * 4 + v], x, y, z, vface, type);
+				uint32_t pos[3] = { x, y, z };
+				uint32_t low[3] = { 3, 5, 7 };
+				CHECK(vface == face && type == 9);
+				CHECK(pos[face / 2] == low[face / 2] + 2 * (face & 1));
+				for (int axis = 0; axis < 3; axis++) {
+					CHECK(pos[axis] == low[axis] || pos[axis] == low[axis] + 2);
+				}
+			}
+			quad++;
+		}
+	}
+	CHECK(renderer.vertexArray.capacity() == capacity);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+/* A minimal test harness, so the tests need nothing beyond what VoxelCube itself links
+*
+* TEST(name) defines a test and registers it with the runner in Main.cpp. CHECK(condition) reports a failure with its
+* file and line, and carries on with the rest of the test. The runner creates a hidden window first, as the octrees and
+* the renderer need a GL context (they create shaders and buffers). Run it from the VoxelCube directory, so the shaders
+* are found.
+*/
+
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+namespace Test {
+	typedef void (*TestFunction)();
+
+	struct TestCase {
+		const char* name;
+		TestFunction function;
+	};
+
+	/* Every registered test, in the order the static registrations ran */
+	inline std::vector<TestCase>& Registry() {
+		static std::vector<TestCase> tests;
+		return tests;
+	}
+
+	/* Failed checks of the test that is running */
+	inline size_t& Failures() {
+		static size_t failures = 0;
+		return failures;
+	}
+
+	struct Registration {
+		Registration(const char* name, TestFunction function) { Registry().push_back({ name, function }); }
+	};
+
+	inline void Fail(const char* condition, const char* file, int line) {
+		std::cout << "  " << file << ":" << line << ": CHECK(" << condition << ") failed" << std::endl;
+		Failures()++;
+	}
+}
+
+#define TEST(name) \
+	static void name(); \
+	static Test::Registration name##_registration(#name, name); \
+	static void name()
+
+#define CHECK(condition) \
+	do { if (!(condition)) { Test::Fail(#condition, __FILE__, __LINE__); } } while (0)
@@ -0,0 +1,51 @@
+#include <atomic>
+#include <vector>
+#include "Test.h"
+#include "Core/WorkerPool.h"
+
+/* Every job of a batch runs exactly once, on a worker with a valid index, however many batches run after each other
+and however small they are */
+TEST(WorkerPoolRunsEveryJobOnce) {
+	for (unsigned int threads : { 1U, 3U, 0U }) {
+		WorkerPool pool(threads);
+		CHECK(pool.ThreadCount() > 0);
+		CHECK(threads == 0 || pool.ThreadCount() == threads);
+
+		for (size_t count : { 0, 1, 7, 1000, 5, 20000 }) {
+			std::vector<std::atomic<int>> runs(count);
+			std::atomic<bool> badWorker{ false };
+			pool.Start(count, [&](size_t job, unsigned int worker) {
+				runs[job]++;
+				if (worker >= pool.ThreadCount()) {
+					badWorker = true;
+				}
+			});
+			pool.Wait();
+			CHECK(pool.Done());
+			CHECK(!badWorker);
+			size_t wrong = 0;
+			for (size_t i = 0; i < count; i++) {
+				wrong += runs[i] != 1;
+			}
+			CHECK(wrong == 0);
+		}
+	}
+}
+
+/* Start returns right away, and Done only turns true once the last job has returned */
+TEST(WorkerPoolDoneAfterLastJob) {
+	WorkerPool pool(2);
+	std::atomic<bool> release{ false };
+	std::atomic<size_t> finished{ 0 };
+	pool.Start(4, [&](size_t, unsigned int) {
+		while (!release) {
+			std::this_thread::yield();
+		}
+		finished++;
+	});
+	CHECK(!pool.Done());
+	release = true;
+	pool.Wait();
+	CHECK(pool.Done());
+	CHECK(finished == 4);
+}